@@ -9,6 +9,7 @@
 
 #include "db/compaction/compaction.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <vector>
 #include <spdlog/spdlog.h>
@@ -421,17 +422,49 @@ bool Compaction::IsTrivialMove() const {
 
   std::unique_ptr<SstPartitioner> partitioner = CreateSstPartitioner();
 
-  for (const auto& file : inputs_.front().files) {
-    std::vector<FileMetaData*> file_grand_parents;
-    if (output_level_ + 1 >= number_levels_) {
-      continue;
+  // Sum each input file's grandparent overlap from a prefix-sum table over
+  // the grandparent level: a pair of binary searches per input file instead
+  // of materializing the overlapping files into a vector and walking it.
+  // Grandparent levels are > 0, so their files are sorted and disjoint.
+  const std::vector<FileMetaData*>* grandparent_files = nullptr;
+  std::vector<uint64_t> grandparent_prefix_sizes;
+  if (output_level_ + 1 < number_levels_) {
+    grandparent_files = &input_vstorage_->LevelFiles(output_level_ + 1);
+    grandparent_prefix_sizes.reserve(grandparent_files->size() + 1);
+    grandparent_prefix_sizes.push_back(0);
+    for (const FileMetaData* gf : *grandparent_files) {
+      grandparent_prefix_sizes.push_back(grandparent_prefix_sizes.back() +
+                                         gf->fd.GetFileSize());
     }
-    input_vstorage_->GetOverlappingInputs(output_level_ + 1, &file->smallest,
-                                          &file->largest, &file_grand_parents);
-    const auto compaction_size =
-        file->fd.GetFileSize() + TotalFileSize(file_grand_parents);
-    if (compaction_size > max_compaction_bytes_) {
-      return false;
+  }
+  const Comparator* ucmp = input_vstorage_->InternalComparator()->user_comparator();
+
+  for (const auto& file : inputs_.front().files) {
+    if (grandparent_files != nullptr) {
+      // Same bounds as GetOverlappingInputsRangeBinarySearch with
+      // within_interval == false: first grandparent whose largest key
+      // reaches the file, one past the last whose smallest key does.
+      auto begin_it = std::lower_bound(
+          grandparent_files->begin(), grandparent_files->end(),
+          &file->smallest,
+          [ucmp](const FileMetaData* f, const InternalKey* k) {
+            return sstableKeyCompare(ucmp, f->largest, *k) < 0;
+          });
+      auto end_it = std::upper_bound(
+          begin_it, grandparent_files->end(), &file->largest,
+          [ucmp](const InternalKey* k, const FileMetaData* f) {
+            return sstableKeyCompare(ucmp, *k, f->smallest) < 0;
+          });
+      const size_t lo =
+          static_cast<size_t>(begin_it - grandparent_files->begin());
+      const size_t hi =
+          static_cast<size_t>(end_it - grandparent_files->begin());
+      const uint64_t compaction_size =
+          file->fd.GetFileSize() +
+          (grandparent_prefix_sizes[hi] - grandparent_prefix_sizes[lo]);
+      if (compaction_size > max_compaction_bytes_) {
+        return false;
+      }
     }
 
     if (partitioner.get() != nullptr) {
@@ -446,13 +479,23 @@ bool Compaction::IsTrivialMove() const {
 }
 
 void Compaction::AddInputDeletions(VersionEdit* out_edit) {
-  SPDLOG_INFO("compaction begin");
+  // Evaluate the log arguments (including the clock read, taken once instead
+  // of once per input file) only when the info sink is actually enabled.
+  const bool log_deletes = spdlog::should_log(spdlog::level::info);
+  long long epoch_seconds = 0;
+  if (log_deletes) {
+    SPDLOG_INFO("compaction begin");
+    epoch_seconds = std::chrono::duration_cast<std::chrono::seconds>(
+                        std::chrono::system_clock::now().time_since_epoch())
+                        .count();
+  }
   for (size_t which = 0; which < num_input_levels(); which++) {
     for (size_t i = 0; i < inputs_[which].size(); i++) {
       out_edit->DeleteFile(level(which), inputs_[which][i]->fd.GetNumber());
-      SPDLOG_INFO("delete {} {} {}", inputs_[which][i]->fd.GetNumber(), std::chrono::duration_cast<std::chrono::seconds>(
-                  std::chrono::system_clock::now().time_since_epoch())
-                  .count(), inputs_[which].level);
+      if (log_deletes) {
+        SPDLOG_INFO("delete {} {} {}", inputs_[which][i]->fd.GetNumber(),
+                    epoch_seconds, inputs_[which].level);
+      }
     }
   }
 }
@@ -560,13 +603,13 @@ int InputSummary(const std::vector<FileMetaData*>& files, char* output,
                  int len) {
   *output = '\0';
   int write = 0;
-  for (size_t i = 0; i < files.size(); i++) {
+  for (const FileMetaData* file : files) {
     int sz = len - write;
     int ret;
     char sztxt[16];
-    AppendHumanBytes(files.at(i)->fd.GetFileSize(), sztxt, 16);
+    AppendHumanBytes(file->fd.GetFileSize(), sztxt, 16);
     ret = snprintf(output + write, sz, "%" PRIu64 "(%s) ",
-                   files.at(i)->fd.GetNumber(), sztxt);
+                   file->fd.GetNumber(), sztxt);
     if (ret < 0 || ret >= sz) break;
     write += ret;
   }
@@ -5,9 +5,14 @@
 
 #include "db/compaction/compaction_iterator.h"
 
+#include <algorithm>
 #include <iterator>
 #include <limits>
 
+#ifdef HAVE_AVX2
+#include <immintrin.h>
+#endif
+
 #include "db/blob/blob_fetcher.h"
 #include "db/blob/blob_file_builder.h"
 #include "db/blob/blob_index.h"
@@ -81,6 +86,8 @@ CompactionIterator::CompactionIterator(
       allow_data_in_errors_(allow_data_in_errors),
       enforce_single_del_contracts_(enforce_single_del_contracts),
       timestamp_size_(cmp_ ? cmp_->timestamp_size() : 0),
+      bytewise_user_key_equality_(cmp_ == BytewiseComparator() ||
+                                  cmp_ == ReverseBytewiseComparator()),
       full_history_ts_low_(full_history_ts_low),
       current_user_key_sequence_(0),
       current_user_key_snapshot_(0),
@@ -195,13 +202,8 @@ void CompactionIterator::Next() {
   PrepareOutput();
 }
 
-bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
-                                              Slice* skip_until) {
-  // TODO: support compaction filter for wide-column entities
-  if (!compaction_filter_ ||
-      (ikey_.type != kTypeValue && ikey_.type != kTypeBlobIndex)) {
-    return true;
-  }
+bool CompactionIterator::ApplyCompactionFilter(bool* need_skip,
+                                               Slice* skip_until) {
   bool error = false;
   // If the user has specified a compaction filter and the sequence
   // number is greater than any external snapshot, then invoke the
@@ -390,11 +392,12 @@ void CompactionIterator::NextFromInput() {
     }
     TEST_SYNC_POINT_CALLBACK("CompactionIterator:ProcessKV", &ikey_);
 
-    // Update input statistics
-    if (ikey_.type == kTypeDeletion || ikey_.type == kTypeSingleDeletion ||
-        ikey_.type == kTypeDeletionWithTimestamp) {
-      iter_stats_.num_input_deletion_records++;
-    }
+    // Update input statistics. The deletion-type test is folded into the
+    // increment so mixed point/delete workloads don't pay a mispredicted
+    // branch per key for a counter update.
+    iter_stats_.num_input_deletion_records +=
+        (ikey_.type == kTypeDeletion || ikey_.type == kTypeSingleDeletion ||
+         ikey_.type == kTypeDeletionWithTimestamp);
     iter_stats_.total_input_raw_key_bytes += key_.size();
     iter_stats_.total_input_raw_value_bytes += value_.size();
 
@@ -409,7 +412,9 @@ void CompactionIterator::NextFromInput() {
     int cmp_ts = 0;
     if (has_current_user_key_) {
       user_key_equal_without_ts =
-          cmp_->EqualWithoutTimestamp(ikey_.user_key, current_user_key_);
+          bytewise_user_key_equality_
+              ? ikey_.user_key == current_user_key_
+              : cmp_->EqualWithoutTimestamp(ikey_.user_key, current_user_key_);
       // if timestamp_size_ > 0, then curr_ts_ has been initialized by a
       // previous key.
       cmp_ts = timestamp_size_ ? cmp_->CompareTimestamp(
@@ -1186,6 +1191,47 @@ void CompactionIterator::PrepareOutput() {
   }
 }
 
+namespace {
+
+// Returns an iterator to the first snapshot >= target, like std::lower_bound.
+// Snapshot lists are usually short and this runs once per visible key, so
+// with AVX2 a linear scan comparing four sequence numbers per step beats the
+// branchy binary search; long lists and other platforms keep
+// std::lower_bound. The signed 64-bit SIMD compare is safe because sequence
+// numbers are bounded by kMaxSequenceNumber (2^56 - 1).
+std::vector<SequenceNumber>::const_iterator FindMinSnapshotGE(
+    const std::vector<SequenceNumber>& snapshots, SequenceNumber target) {
+#ifdef HAVE_AVX2
+  constexpr size_t kMaxLinearScan = 64;
+  const size_t n = snapshots.size();
+  if (n <= kMaxLinearScan) {
+    const __m256i vtarget =
+        _mm256_set1_epi64x(static_cast<long long>(target));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      const __m256i v = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(snapshots.data() + i));
+      // A lane is all-ones iff target > snapshots[i + lane]; the first lane
+      // that is not signals the first snapshot >= target.
+      const uint32_t gt_mask = static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpgt_epi64(vtarget, v)));
+      if (gt_mask != 0xffffffffu) {
+        return snapshots.begin() + i + (__builtin_ctz(~gt_mask) >> 3);
+      }
+    }
+    for (; i < n; ++i) {
+      if (snapshots[i] >= target) {
+        return snapshots.begin() + i;
+      }
+    }
+    return snapshots.end();
+  }
+#endif
+  return std::lower_bound(snapshots.begin(), snapshots.end(), target);
+}
+
+}  // namespace
+
 inline SequenceNumber CompactionIterator::findEarliestVisibleSnapshot(
     SequenceNumber in, SequenceNumber* prev_snapshot) {
   assert(snapshots_->size());
@@ -1193,8 +1239,7 @@ inline SequenceNumber CompactionIterator::findEarliestVisibleSnapshot(
     ROCKS_LOG_FATAL(info_log_,
                     "No snapshot left in findEarliestVisibleSnapshot");
   }
-  auto snapshots_iter = std::lower_bound(
-      snapshots_->begin(), snapshots_->end(), in);
+  auto snapshots_iter = FindMinSnapshotGE(*snapshots_, in);
   assert(prev_snapshot != nullptr);
   if (snapshots_iter == snapshots_->begin()) {
     *prev_snapshot = 0;
@@ -19,6 +19,7 @@
 #include "db/snapshot_checker.h"
 #include "options/cf_options.h"
 #include "rocksdb/compaction_filter.h"
+#include "table/iterator_wrapper.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -35,26 +36,26 @@ class SequenceIterWrapper : public InternalIterator {
       : icmp_(cmp),
         inner_iter_(iter),
         need_count_entries_(need_count_entries) {}
-  bool Valid() const override { return inner_iter_->Valid(); }
-  Status status() const override { return inner_iter_->status(); }
+  bool Valid() const override { return inner_iter_.Valid(); }
+  Status status() const override { return inner_iter_.status(); }
   void Next() override {
     num_itered_++;
-    inner_iter_->Next();
+    inner_iter_.Next();
   }
   void Seek(const Slice& target) override {
     if (!need_count_entries_) {
-      inner_iter_->Seek(target);
+      inner_iter_.Seek(target);
     } else {
       // For flush cases, we need to count total number of entries, so we
       // do Next() rather than Seek().
-      while (inner_iter_->Valid() &&
-             icmp_.Compare(inner_iter_->key(), target) < 0) {
+      while (inner_iter_.Valid() &&
+             icmp_.Compare(inner_iter_.key(), target) < 0) {
         Next();
       }
     }
   }
-  Slice key() const override { return inner_iter_->key(); }
-  Slice value() const override { return inner_iter_->value(); }
+  Slice key() const override { return inner_iter_.key(); }
+  Slice value() const override { return inner_iter_.value(); }
 
   // Unused InternalIterator methods
   void SeekToFirst() override { assert(false); }
@@ -66,7 +67,11 @@ class SequenceIterWrapper : public InternalIterator {
 
  private:
   InternalKeyComparator icmp_;
-  InternalIterator* inner_iter_;  // not owned
+  // Caches the inner iterator's Valid()/key() results so the per-record
+  // accesses from CompactionIterator don't virtual-dispatch into the
+  // (possibly wrapped) input iterator, and advances it through the fused
+  // NextAndGetResult. Does not own the iterator.
+  IteratorWrapper inner_iter_;
   uint64_t num_itered_ = 0;
   bool need_count_entries_;
 };
@@ -282,7 +287,19 @@ class CompactionIterator {
 
   // Invoke compaction filter if needed.
   // Return true on success, false on failures (e.g.: kIOError).
-  bool InvokeFilterIfNeeded(bool* need_skip, Slice* skip_until);
+  // Most compactions run without a compaction filter, so the gate is inline
+  // and the no-filter path never leaves the calling loop.
+  bool InvokeFilterIfNeeded(bool* need_skip, Slice* skip_until) {
+    // TODO: support compaction filter for wide-column entities
+    if (!compaction_filter_ ||
+        (ikey_.type != kTypeValue && ikey_.type != kTypeBlobIndex)) {
+      return true;
+    }
+    return ApplyCompactionFilter(need_skip, skip_until);
+  }
+
+  // Out-of-line part of InvokeFilterIfNeeded() for when a filter applies.
+  bool ApplyCompactionFilter(bool* need_skip, Slice* skip_until);
 
   // Given a sequence number, return the sequence number of the
   // earliest snapshot that this sequence number is visible in.
@@ -363,6 +380,12 @@ class CompactionIterator {
   // Comes from comparator.
   const size_t timestamp_size_;
 
+  // True when user keys can be compared for equality byte-wise, i.e. the
+  // column family uses one of the built-in bytewise comparators (which have
+  // no user-defined timestamps). Lets the per-key user-key-change check skip
+  // a virtual comparator call.
+  const bool bytewise_user_key_equality_;
+
   // Lower bound timestamp to retain full history in terms of user-defined
   // timestamp. If a key's timestamp is older than full_history_ts_low_, then
   // the key *may* be eligible for garbage collection (GC). The skipping logic
@@ -10,9 +10,12 @@
 #include "db/compaction/compaction_job.h"
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
 #include <memory>
 #include <set>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -54,52 +57,48 @@
 #include "test_util/sync_point.h"
 #include "util/stop_watch.h"
 
+#ifdef HAVE_AVX2
+#include <immintrin.h>
+#endif
+
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// Indexed by CompactionReason; must be kept in the same order as the enum in
+// include/rocksdb/listener.h.
+constexpr std::array<const char*,
+                     static_cast<size_t>(CompactionReason::kNumOfReasons)>
+    kCompactionReasonStrings = {{
+        "Unknown",
+        "LevelL0FilesNum",
+        "LevelMaxLevelSize",
+        "UniversalSizeAmplification",
+        "UniversalSizeRatio",
+        "UniversalSortedRunNum",
+        "FIFOMaxSize",
+        "FIFOReduceNumFiles",
+        "FIFOTtl",
+        "ManualCompaction",
+        "FilesMarkedForCompaction",
+        "BottommostFiles",
+        "Ttl",
+        "Flush",
+        "ExternalSstIngestion",
+        "PeriodicCompaction",
+        "ChangeTemperature",
+        "ForcedBlobGC",
+    }};
+}  // namespace
+
 const char* GetCompactionReasonString(CompactionReason compaction_reason) {
-  switch (compaction_reason) {
-    case CompactionReason::kUnknown:
-      return "Unknown";
-    case CompactionReason::kLevelL0FilesNum:
-      return "LevelL0FilesNum";
-    case CompactionReason::kLevelMaxLevelSize:
-      return "LevelMaxLevelSize";
-    case CompactionReason::kUniversalSizeAmplification:
-      return "UniversalSizeAmplification";
-    case CompactionReason::kUniversalSizeRatio:
-      return "UniversalSizeRatio";
-    case CompactionReason::kUniversalSortedRunNum:
-      return "UniversalSortedRunNum";
-    case CompactionReason::kFIFOMaxSize:
-      return "FIFOMaxSize";
-    case CompactionReason::kFIFOReduceNumFiles:
-      return "FIFOReduceNumFiles";
-    case CompactionReason::kFIFOTtl:
-      return "FIFOTtl";
-    case CompactionReason::kManualCompaction:
-      return "ManualCompaction";
-    case CompactionReason::kFilesMarkedForCompaction:
-      return "FilesMarkedForCompaction";
-    case CompactionReason::kBottommostFiles:
-      return "BottommostFiles";
-    case CompactionReason::kTtl:
-      return "Ttl";
-    case CompactionReason::kFlush:
-      return "Flush";
-    case CompactionReason::kExternalSstIngestion:
-      return "ExternalSstIngestion";
-    case CompactionReason::kPeriodicCompaction:
-      return "PeriodicCompaction";
-    case CompactionReason::kChangeTemperature:
-      return "ChangeTemperature";
-    case CompactionReason::kForcedBlobGC:
-      return "ForcedBlobGC";
-    case CompactionReason::kNumOfReasons:
-      // fall through
-    default:
-      assert(false);
-      return "Invalid";
-  }
+  // The enum is dense and zero-based, so a direct table lookup avoids the
+  // jump table a switch would generate at every logging/stats call site.
+  const size_t i = static_cast<size_t>(compaction_reason);
+  if (i < kCompactionReasonStrings.size()) {
+    return kCompactionReasonStrings[i];
+  }
+  assert(false);
+  return "Invalid";
 }
 
 CompactionJob::CompactionJob(
@@ -131,37 +130,56 @@ CompactionJob::CompactionJob(
       bottommost_level_(false),
       write_hint_(Env::WLTH_NOT_SET),
       compaction_job_stats_(compaction_job_stats),
-      job_id_(job_id),
-      dbname_(dbname),
-      db_id_(db_id),
-      db_session_id_(db_session_id),
-      file_options_(file_options),
+      versions_(versions),
       env_(db_options.env),
-      io_tracer_(io_tracer),
       fs_(db_options.fs, io_tracer),
-      file_options_for_read_(
-          fs_->OptimizeForCompactionTableRead(file_options, db_options_)),
-      versions_(versions),
-      shutting_down_(shutting_down),
-      manual_compaction_canceled_(manual_compaction_canceled),
-      db_directory_(db_directory),
-      blob_output_directory_(blob_output_directory),
       db_mutex_(db_mutex),
       db_error_handler_(db_error_handler),
-      existing_snapshots_(std::move(existing_snapshots)),
-      earliest_write_conflict_snapshot_(earliest_write_conflict_snapshot),
+      db_directory_(db_directory),
+      blob_output_directory_(blob_output_directory),
+      shutting_down_(shutting_down),
+      manual_compaction_canceled_(manual_compaction_canceled),
       snapshot_checker_(snapshot_checker),
       job_context_(job_context),
-      table_cache_(std::move(table_cache)),
       event_logger_(event_logger),
+      blob_callback_(blob_callback),
+      job_id_(job_id),
+      earliest_write_conflict_snapshot_(earliest_write_conflict_snapshot),
       paranoid_file_checks_(paranoid_file_checks),
       measure_io_stats_(measure_io_stats),
       thread_pri_(thread_pri),
+      dbname_(dbname),
+      db_id_(db_id),
+      db_session_id_(db_session_id),
+      file_options_(file_options),
+      file_options_for_read_(
+          fs_->OptimizeForCompactionTableRead(file_options, db_options_)),
+      io_tracer_(io_tracer),
+      existing_snapshots_(std::move(existing_snapshots)),
+      job_earliest_snapshot_(existing_snapshots_.empty()
+                                 ? kMaxSequenceNumber
+                                 : existing_snapshots_[0]),
+      table_cache_(std::move(table_cache)),
       full_history_ts_low_(std::move(full_history_ts_low)),
       trim_ts_(std::move(trim_ts)),
-      blob_callback_(blob_callback) {
+      output_file_preallocation_size_(
+          compaction->OutputFilePreallocationSize()) {
   assert(compaction_job_stats_ != nullptr);
   assert(log_buffer_ != nullptr);
+  // The snapshot list arrives sorted from DBImpl (the compaction iterator
+  // depends on that ordering); trim the spare capacity since the vector
+  // lives for the whole job and is searched per key.
+  assert(std::is_sorted(existing_snapshots_.begin(),
+                        existing_snapshots_.end()));
+  existing_snapshots_.shrink_to_fit();
+  if (versions_ != nullptr && versions_->GetColumnFamilySet() != nullptr) {
+    write_controller_ = versions_->GetColumnFamilySet()->write_controller();
+  }
+  // Re-deriving the unique-id prefix per output file would re-decode the
+  // session id and re-hash the db id each time; both are fixed for the job.
+  unique_id_prefix_valid_ =
+      GetSstInternalUniqueIdPrefix(db_id_, db_session_id_, &unique_id_prefix_)
+          .ok();
   const auto* cfd = compact_->compaction->column_family_data();
   ThreadStatusUtil::SetColumnFamily(cfd, cfd->ioptions()->env,
                                     db_options_.enable_thread_tracking);
@@ -179,34 +197,33 @@ void CompactionJob::ReportStartedCompaction(Compaction* compaction) {
   ThreadStatusUtil::SetColumnFamily(cfd, cfd->ioptions()->env,
                                     db_options_.enable_thread_tracking);
 
-  ThreadStatusUtil::SetThreadOperationProperty(ThreadStatus::COMPACTION_JOB_ID,
-                                               job_id_);
-
-  ThreadStatusUtil::SetThreadOperationProperty(
-      ThreadStatus::COMPACTION_INPUT_OUTPUT_LEVEL,
-      (static_cast<uint64_t>(compact_->compaction->start_level()) << 32) +
-          compact_->compaction->output_level());
-
   // In the current design, a CompactionJob is always created
   // for non-trivial compaction.
   assert(compaction->IsTrivialMove() == false ||
          compaction->is_manual_compaction() == true);
 
-  ThreadStatusUtil::SetThreadOperationProperty(
-      ThreadStatus::COMPACTION_PROP_FLAGS,
-      compaction->is_manual_compaction() +
-          (compaction->deletion_compaction() << 1));
-
-  ThreadStatusUtil::SetThreadOperationProperty(
-      ThreadStatus::COMPACTION_TOTAL_INPUT_BYTES,
-      compaction->CalculateTotalInputSize());
+  // Set all compaction properties with a single thread-local resolution
+  // instead of one per property. The array is laid out in enum order,
+  // starting at COMPACTION_JOB_ID.
+  static_assert(ThreadStatus::COMPACTION_BYTES_WRITTEN ==
+                    ThreadStatus::COMPACTION_JOB_ID + 5,
+                "compaction operation properties are expected to be "
+                "consecutive");
+  const uint64_t props[] = {
+      job_id_,
+      (static_cast<uint64_t>(compact_->compaction->start_level()) << 32) +
+          compact_->compaction->output_level(),
+      static_cast<uint64_t>(compaction->is_manual_compaction() +
+                            (compaction->deletion_compaction() << 1)),
+      compaction->CalculateTotalInputSize(),
+      0 /* COMPACTION_BYTES_READ */,
+      0 /* COMPACTION_BYTES_WRITTEN */};
+  ThreadStatusUtil::SetThreadOperationProperties(
+      ThreadStatus::COMPACTION_JOB_ID, props,
+      static_cast<int>(sizeof(props) / sizeof(props[0])));
 
   IOSTATS_RESET(bytes_written);
   IOSTATS_RESET(bytes_read);
-  ThreadStatusUtil::SetThreadOperationProperty(
-      ThreadStatus::COMPACTION_BYTES_WRITTEN, 0);
-  ThreadStatusUtil::SetThreadOperationProperty(
-      ThreadStatus::COMPACTION_BYTES_READ, 0);
 
   // Set the thread operation after operation properties
   // to ensure GetThreadList() can always show them all together.
@@ -217,6 +234,16 @@ void CompactionJob::ReportStartedCompaction(Compaction* compaction) {
   compaction_job_stats_->is_full_compaction = compaction->is_full_compaction();
 }
 
+void CompactionJob::ResolveOutputTemperature() {
+  const Compaction* c = compact_->compaction;
+  resolved_output_temperature_ = c->output_temperature();
+  if (resolved_output_temperature_ == Temperature::kUnknown &&
+      bottommost_level_) {
+    resolved_output_temperature_ =
+        c->mutable_cf_options()->bottommost_temperature;
+  }
+}
+
 void CompactionJob::Prepare() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_PREPARE);
@@ -230,16 +257,26 @@ void CompactionJob::Prepare() {
   write_hint_ =
       c->column_family_data()->CalculateSSTWriteHint(c->output_level());
   bottommost_level_ = c->bottommost_level();
-
-  if (c->ShouldFormSubcompactions()) {
+  ResolveOutputTemperature();
+
+  // Boundary generation walks the input metadata and issues an
+  // ApproximateSize call per candidate range, which may read index blocks.
+  // If the whole input fits in fewer than two target output files the job
+  // can never be split anyway, so skip that work and run single-threaded.
+  if (c->ShouldFormSubcompactions() &&
+      c->CalculateTotalInputSize() / 2 >= c->max_output_file_size()) {
+    autovector<Slice, 16> boundaries;
     {
       StopWatch sw(db_options_.clock, stats_, SUBCOMPACTION_SETUP_TIME);
-      GenSubcompactionBoundaries();
+      boundaries = GenSubcompactionBoundaries();
     }
 
-    for (size_t i = 0; i <= boundaries_.size(); i++) {
-      Slice* start = i == 0 ? nullptr : &boundaries_[i - 1];
-      Slice* end = i == boundaries_.size() ? nullptr : &boundaries_[i];
+    // Each SubcompactionState copies its boundary bytes out of the returned
+    // Slices, so nothing here outlives this scope.
+    compact_->sub_compact_states.reserve(boundaries.size() + 1);
+    for (size_t i = 0; i <= boundaries.size(); i++) {
+      const Slice* start = i == 0 ? nullptr : &boundaries[i - 1];
+      const Slice* end = i == boundaries.size() ? nullptr : &boundaries[i];
       compact_->sub_compact_states.emplace_back(c, start, end,
                                                 static_cast<uint32_t>(i));
     }
@@ -261,14 +298,188 @@ struct RangeWithSize {
       : range(a, b), size(s) {}
 };
 
-void CompactionJob::GenSubcompactionBoundaries() {
+namespace {
+
+// Tuning knobs for the bytewise boundary sort below: how many leading user
+// key bytes are used for radix bucketing before falling back to std::sort,
+// and the bucket size under which std::sort is used directly.
+constexpr size_t kBoundsRadixMaxDepth = 3;
+constexpr size_t kBoundsRadixMinBucketSize = 32;
+
+// Bytewise "less" on raw key bytes. With AVX2, compares 32 bytes per
+// iteration and locates the first differing byte via a compare/movemask pair;
+// otherwise defers to Slice::compare (memcmp).
+inline bool BytewiseSliceLess(const Slice& a, const Slice& b) {
+#ifdef HAVE_AVX2
+  const size_t min_len = std::min(a.size(), b.size());
+  const char* adata = a.data();
+  const char* bdata = b.data();
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= min_len; i += sizeof(__m256i)) {
+    const __m256i va =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(adata + i));
+    const __m256i vb =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bdata + i));
+    const uint32_t eq_mask = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+    if (eq_mask != 0xffffffffu) {
+      const unsigned diff = __builtin_ctz(~eq_mask);
+      return static_cast<unsigned char>(adata[i + diff]) <
+             static_cast<unsigned char>(bdata[i + diff]);
+    }
+  }
+  const int r = memcmp(adata + i, bdata + i, min_len - i);
+  if (r != 0) {
+    return r < 0;
+  }
+  return a.size() < b.size();
+#else
+  return a.compare(b) < 0;
+#endif
+}
+
+// A boundary key together with its precomputed user key view, so the sort
+// and dedup below don't re-run ExtractUserKey on every comparison.
+struct BoundKey {
+  Slice user_key;
+  Slice internal_key;
+};
+
+// Compares the user keys of two boundary keys without going through the
+// virtual Comparator interface. Only valid when the column family uses the
+// default bytewise comparator.
+inline bool BytewiseBoundLess(const BoundKey& a, const BoundKey& b) {
+  return BytewiseSliceLess(a.user_key, b.user_key);
+}
+
+// Sorts [begin, end) by user key with a 256-way MSD radix pass on the byte at
+// `depth`, recursing on each bucket. All keys in the range are assumed to
+// share the first `depth` user key bytes. Small buckets and buckets deeper
+// than kBoundsRadixMaxDepth fall back to std::sort with the memcmp-based
+// comparator above. Only valid for the bytewise comparator, where radix
+// order and comparator order coincide.
+void RadixSortBounds(BoundKey* begin, BoundKey* end, size_t depth) {
+  const size_t num = static_cast<size_t>(end - begin);
+  if (num <= kBoundsRadixMinBucketSize || depth >= kBoundsRadixMaxDepth) {
+    std::sort(begin, end, BytewiseBoundLess);
+    return;
+  }
+  // 256 byte-value buckets plus a leading bucket for user keys with no byte
+  // at this depth; under bytewise ordering shorter keys sort first.
+  std::array<std::vector<BoundKey>, 257> buckets;
+  for (BoundKey* it = begin; it != end; ++it) {
+    const size_t b =
+        depth < it->user_key.size()
+            ? static_cast<size_t>(
+                  static_cast<unsigned char>(it->user_key[depth])) +
+                  1
+            : 0;
+    buckets[b].push_back(*it);
+  }
+  BoundKey* out = begin;
+  for (size_t b = 0; b < buckets.size(); b++) {
+    if (buckets[b].empty()) {
+      continue;
+    }
+    std::copy(buckets[b].begin(), buckets[b].end(), out);
+    if (b > 0) {
+      // Bucket 0 holds user keys that are exhausted at this depth; they are
+      // all equal so there is nothing left to sort.
+      RadixSortBounds(out, out + buckets[b].size(), depth + 1);
+    }
+    out += buckets[b].size();
+  }
+}
+
+// Boundary counts above which the generic-comparator sort is spread over
+// multiple threads. Only very wide compactions (thousands of L0 files during
+// recovery or backfill) get here.
+constexpr size_t kBoundsParallelSortThreshold = 4096;
+
+// Sorts [begin, end) with `cmp` by splitting the range into power-of-two
+// many chunks, sorting the chunks on port::Thread workers, and merging
+// adjacent chunks pairwise with std::inplace_merge (also in parallel, one
+// thread per merge). Used for custom comparators, where the radix path
+// above does not apply.
+template <typename Compare>
+void ParallelSortBounds(BoundKey* begin, BoundKey* end, const Compare& cmp) {
+  const size_t num = static_cast<size_t>(end - begin);
+  size_t num_chunks = 1;
+  const size_t max_chunks = std::max<unsigned int>(
+      1, std::min<unsigned int>(std::thread::hardware_concurrency(), 8));
+  while (2 * num_chunks <= max_chunks &&
+         num / (2 * num_chunks) > kBoundsRadixMinBucketSize) {
+    num_chunks *= 2;
+  }
+  if (num_chunks == 1) {
+    std::sort(begin, end, cmp);
+    return;
+  }
+  std::vector<size_t> offsets;
+  offsets.reserve(num_chunks + 1);
+  for (size_t i = 0; i < num_chunks; i++) {
+    offsets.push_back(i * num / num_chunks);
+  }
+  offsets.push_back(num);
+
+  std::vector<port::Thread> workers;
+  workers.reserve(num_chunks - 1);
+  for (size_t i = 1; i < num_chunks; i++) {
+    workers.emplace_back([begin, &offsets, i, &cmp] {
+      std::sort(begin + offsets[i], begin + offsets[i + 1], cmp);
+    });
+  }
+  std::sort(begin + offsets[0], begin + offsets[1], cmp);
+  for (auto& w : workers) {
+    w.join();
+  }
+
+  // log2(num_chunks) rounds of pairwise merges; each round halves the number
+  // of sorted runs and runs its merges concurrently.
+  for (size_t width = 1; width < num_chunks; width *= 2) {
+    workers.clear();
+    // num_chunks is a power of two, so every merge at this width has a full
+    // complement of offsets.
+    for (size_t i = 2 * width; i + 2 * width <= num_chunks; i += 2 * width) {
+      workers.emplace_back([begin, &offsets, i, width, &cmp] {
+        std::inplace_merge(begin + offsets[i], begin + offsets[i + width],
+                           begin + offsets[i + 2 * width], cmp);
+      });
+    }
+    std::inplace_merge(begin + offsets[0], begin + offsets[width],
+                       begin + offsets[2 * width], cmp);
+    for (auto& w : workers) {
+      w.join();
+    }
+  }
+}
+
+}  // namespace
+
+autovector<Slice, 16> CompactionJob::GenSubcompactionBoundaries() {
+  // Sized by max_subcompactions, which is small, so inline storage avoids a
+  // heap allocation in the common case.
+  autovector<Slice, 16> boundaries;
   auto* c = compact_->compaction;
   auto* cfd = c->column_family_data();
   const Comparator* cfd_comparator = cfd->user_comparator();
-  std::vector<Slice> bounds;
+  std::vector<BoundKey> bounds;
+  // Strip the 8-byte trailer once per boundary here instead of inside every
+  // comparator invocation below.
+  auto add_bound = [&bounds](const Slice& internal_key) {
+    bounds.push_back({ExtractUserKey(internal_key), internal_key});
+  };
   int start_lvl = c->start_level();
   int out_lvl = c->output_level();
 
+  // Reserve the worst case up front (two boundaries per input file) so the
+  // collection loop below never reallocates.
+  size_t total_files = 0;
+  for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+    total_files += c->input_levels(lvl_idx)->num_files;
+  }
+  bounds.reserve(2 * total_files);
+
   // Add the starting and/or ending key of certain input files as a potential
   // boundary
   for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
@@ -285,40 +496,59 @@ void CompactionJob::GenSubcompactionBoundaries() {
         // For level 0 add the starting and ending key of each file since the
         // files may have greatly differing key ranges (not range-partitioned)
         for (size_t i = 0; i < num_files; i++) {
-          bounds.emplace_back(flevel->files[i].smallest_key);
-          bounds.emplace_back(flevel->files[i].largest_key);
+          add_bound(flevel->files[i].smallest_key);
+          add_bound(flevel->files[i].largest_key);
         }
       } else {
         // For all other levels add the smallest/largest key in the level to
         // encompass the range covered by that level
-        bounds.emplace_back(flevel->files[0].smallest_key);
-        bounds.emplace_back(flevel->files[num_files - 1].largest_key);
+        add_bound(flevel->files[0].smallest_key);
+        add_bound(flevel->files[num_files - 1].largest_key);
         if (lvl == out_lvl) {
           // For the last level include the starting keys of all files since
           // the last level is the largest and probably has the widest key
           // range. Since it's range partitioned, the ending key of one file
           // and the starting key of the next are very close (or identical).
           for (size_t i = 1; i < num_files; i++) {
-            bounds.emplace_back(flevel->files[i].smallest_key);
+            add_bound(flevel->files[i].smallest_key);
           }
         }
       }
     }
   }
 
-  std::sort(bounds.begin(), bounds.end(),
-            [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-              return cfd_comparator->Compare(ExtractUserKey(a),
-                                             ExtractUserKey(b)) < 0;
-            });
-  // Remove duplicated entries from bounds
-  bounds.erase(
-      std::unique(bounds.begin(), bounds.end(),
-                  [cfd_comparator](const Slice& a, const Slice& b) -> bool {
-                    return cfd_comparator->Compare(ExtractUserKey(a),
-                                                   ExtractUserKey(b)) == 0;
-                  }),
-      bounds.end());
+  if (cfd_comparator == BytewiseComparator()) {
+    // Fast path for the default comparator: MSD radix bucketing on the
+    // leading user key bytes with memcmp-based sorting inside each bucket.
+    // Avoids a virtual comparator call per comparison, which dominates the
+    // sort when the compaction spans many (e.g. thousands of L0) files.
+    RadixSortBounds(bounds.data(), bounds.data() + bounds.size(), 0);
+    bounds.erase(std::unique(bounds.begin(), bounds.end(),
+                             [](const BoundKey& a, const BoundKey& b) -> bool {
+                               return a.user_key == b.user_key;
+                             }),
+                 bounds.end());
+  } else {
+    auto generic_less = [cfd_comparator](const BoundKey& a,
+                                         const BoundKey& b) -> bool {
+      return cfd_comparator->Compare(a.user_key, b.user_key) < 0;
+    };
+    if (bounds.size() > kBoundsParallelSortThreshold) {
+      ParallelSortBounds(bounds.data(), bounds.data() + bounds.size(),
+                         generic_less);
+    } else {
+      std::sort(bounds.begin(), bounds.end(), generic_less);
+    }
+    // Remove duplicated entries from bounds
+    bounds.erase(
+        std::unique(bounds.begin(), bounds.end(),
+                    [cfd_comparator](const BoundKey& a,
+                                     const BoundKey& b) -> bool {
+                      return cfd_comparator->Compare(a.user_key, b.user_key) ==
+                             0;
+                    }),
+        bounds.end());
+  }
 
   // Combine consecutive pairs of boundaries into ranges with an approximate
   // size of data covered by keys in that range
@@ -328,37 +558,61 @@ void CompactionJob::GenSubcompactionBoundaries() {
   // earlier in SetInputVersioCompaction::SetInputVersion and will not change
   // when db_mutex_ is released below
   auto* v = compact_->compaction->input_version();
-  for (auto it = bounds.begin();;) {
-    const Slice a = *it;
-    ++it;
-
-    if (it == bounds.end()) {
-      break;
-    }
-
-    const Slice b = *it;
-
-    // ApproximateSize could potentially create table reader iterator to seek
-    // to the index block and may incur I/O cost in the process. Unlock db
-    // mutex to reduce contention
+  if (bounds.size() >= 2) {
+    const size_t num_ranges = bounds.size() - 1;
+    std::vector<uint64_t> sizes(num_ranges, 0);
+    // ApproximateSize could potentially create a table reader iterator to
+    // seek to the index block and may incur I/O cost in the process. Release
+    // the db mutex once for the whole batch instead of around every call,
+    // and fan the calls out over a few threads since each one may block on
+    // an independent index block read. Concurrency is capped at
+    // max_subcompactions to avoid over-subscribing the table cache.
+    const size_t num_threads = std::max<size_t>(
+        1, std::min(num_ranges,
+                    static_cast<size_t>(c->max_subcompactions())));
     db_mutex_->Unlock();
-    uint64_t size = versions_->ApproximateSize(SizeApproximationOptions(), v, a,
-                                               b, start_lvl, out_lvl + 1,
-                                               TableReaderCaller::kCompaction);
+    auto approx_size_func = [&](size_t thread_idx) {
+      for (size_t i = thread_idx; i < num_ranges; i += num_threads) {
+        sizes[i] = versions_->ApproximateSize(
+            SizeApproximationOptions(), v, bounds[i].internal_key,
+            bounds[i + 1].internal_key, start_lvl, out_lvl + 1,
+            TableReaderCaller::kCompaction);
+      }
+    };
+    std::vector<port::Thread> thread_pool;
+    thread_pool.reserve(num_threads - 1);
+    for (size_t t = 1; t < num_threads; t++) {
+      thread_pool.emplace_back(approx_size_func, t);
+    }
+    // While the workers are blocked on index block reads, overlap the
+    // CPU-only construction of the ranges vector on this thread; the sizes
+    // are patched in once the workers have joined. Only then does this
+    // thread take its own share of the ApproximateSize calls.
+    ranges.reserve(num_ranges);
+    for (size_t i = 0; i < num_ranges; i++) {
+      ranges.emplace_back(bounds[i].internal_key, bounds[i + 1].internal_key,
+                          0);
+    }
+    approx_size_func(0);
+    for (auto& thread : thread_pool) {
+      thread.join();
+    }
     db_mutex_->Lock();
-    ranges.emplace_back(a, b, size);
-    sum += size;
+    for (size_t i = 0; i < num_ranges; i++) {
+      ranges[i].size = sizes[i];
+      sum += sizes[i];
+    }
   }
 
   // Group the ranges into subcompactions
   const double min_file_fill_percent = 4.0 / 5;
-  int base_level = v->storage_info()->base_level();
-  uint64_t max_output_files = static_cast<uint64_t>(std::ceil(
-      sum / min_file_fill_percent /
-      MaxFileSizeForLevel(
-          *(c->mutable_cf_options()), out_lvl,
-          c->immutable_options()->compaction_style, base_level,
-          c->immutable_options()->level_compaction_dynamic_level_bytes)));
+  // The picker already derived the target output file size for this
+  // compaction with the same MaxFileSizeForLevel() arguments when the
+  // compaction was created, so read the cached value instead of recomputing
+  // it through the options indirections. Subcompaction threads read the same
+  // member lock-free when rotating output files.
+  uint64_t max_output_files = static_cast<uint64_t>(
+      std::ceil(sum / min_file_fill_percent / c->max_output_file_size()));
   uint64_t subcompactions =
       std::min({static_cast<uint64_t>(ranges.size()),
                 static_cast<uint64_t>(c->max_subcompactions()),
@@ -377,14 +631,46 @@ void CompactionJob::GenSubcompactionBoundaries() {
         continue;
       }
       if (sum >= mean) {
-        boundaries_.emplace_back(ExtractUserKey(ranges[i].range.limit));
+        // ranges[i].range.limit is bounds[i + 1].internal_key, whose user key
+        // view was already computed above.
+        boundaries.emplace_back(bounds[i + 1].user_key);
         subcompactions--;
         sum = 0;
       }
     }
   }
+  return boundaries;
+}
+
+namespace {
+
+// Streams every record of `iter` into `validator`. Advancing, validity check
+// and key access are fused through NextAndGetResult() so each record costs
+// two virtual calls instead of four.
+Status ValidateAllRecords(InternalIterator* iter, OutputValidator& validator) {
+  Status s;
+  iter->SeekToFirst();
+  if (!iter->Valid()) {
+    return s;
+  }
+  IterateResult result;
+  result.key = iter->key();
+  bool valid = true;
+  while (valid) {
+    if (!result.value_prepared && !iter->PrepareValue()) {
+      return iter->status();
+    }
+    s = validator.Add(result.key, iter->value());
+    if (!s.ok()) {
+      return s;
+    }
+    valid = iter->NextAndGetResult(&result);
+  }
+  return s;
 }
 
+}  // namespace
+
 Status CompactionJob::Run() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_RUN);
@@ -448,28 +734,28 @@ Status CompactionJob::Run() {
     io_status_ = io_s;
   }
   if (status.ok()) {
-    constexpr IODebugContext* dbg = nullptr;
+    // Fsync of the output directory(s) blocks for several milliseconds on
+    // common file systems and is independent of the table verification
+    // below, so run it on a helper thread and overlap the two. Both must
+    // still succeed before the results are installed; the fsync result is
+    // merged into io_s/status after the join below.
+    port::Thread dir_fsync_thread([&] {
+      constexpr IODebugContext* dbg = nullptr;
+
+      if (output_directory_) {
+        io_s = output_directory_->FsyncWithDirOptions(
+            IOOptions(), dbg,
+            DirFsyncOptions(DirFsyncOptions::FsyncReason::kNewFileSynced));
+      }
 
-    if (output_directory_) {
-      io_s = output_directory_->FsyncWithDirOptions(
-          IOOptions(), dbg,
-          DirFsyncOptions(DirFsyncOptions::FsyncReason::kNewFileSynced));
-    }
+      if (io_s.ok() && wrote_new_blob_files && blob_output_directory_ &&
+          blob_output_directory_ != output_directory_) {
+        io_s = blob_output_directory_->FsyncWithDirOptions(
+            IOOptions(), dbg,
+            DirFsyncOptions(DirFsyncOptions::FsyncReason::kNewFileSynced));
+      }
+    });
 
-    if (io_s.ok() && wrote_new_blob_files && blob_output_directory_ &&
-        blob_output_directory_ != output_directory_) {
-      io_s = blob_output_directory_->FsyncWithDirOptions(
-          IOOptions(), dbg,
-          DirFsyncOptions(DirFsyncOptions::FsyncReason::kNewFileSynced));
-    }
-  }
-  if (io_status_.ok()) {
-    io_status_ = io_s;
-  }
-  if (status.ok()) {
-    status = io_s;
-  }
-  if (status.ok()) {
     thread_pool.clear();
     std::vector<const CompactionOutputs::Output*> files_output;
     for (const auto& state : compact_->sub_compact_states) {
@@ -494,6 +780,13 @@ Status CompactionJob::Run() {
         // we will regard this verification as user reads since the goal is
         // to cache it here for further user reads
         ReadOptions read_options;
+        // The scan over the freshly written file is strictly sequential and
+        // may miss both caches (e.g. when the file was written with direct
+        // I/O), so request large readahead and let the reader overlap block
+        // reads with iteration instead of faulting blocks in one at a time.
+        read_options.readahead_size = 2 << 20;
+        read_options.adaptive_readahead = true;
+        read_options.async_io = true;
         InternalIterator* iter = cfd->table_cache()->NewIterator(
             read_options, file_options_, cfd->internal_comparator(),
             files_output[file_idx]->meta, /*range_del_agg=*/nullptr,
@@ -514,12 +807,7 @@ Status CompactionJob::Run() {
           OutputValidator validator(cfd->internal_comparator(),
                                     /*_enable_order_check=*/true,
                                     /*_enable_hash=*/true);
-          for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
-            s = validator.Add(iter->key(), iter->value());
-            if (!s.ok()) {
-              break;
-            }
-          }
+          s = ValidateAllRecords(iter, validator);
           if (s.ok()) {
             s = iter->status();
           }
@@ -537,7 +825,14 @@ Status CompactionJob::Run() {
         }
       }
     };
-    for (size_t i = 1; i < compact_->sub_compact_states.size(); i++) {
+    // Spawning a thread costs tens of microseconds, so size the fan-out by
+    // the work available instead of launching one thread per subcompaction
+    // unconditionally: with k output files at most k threads (including this
+    // one) can make progress on the shared work queue. Small compactions
+    // (zero or one output) verify inline without any thread creation.
+    const size_t num_verify_threads =
+        std::min(compact_->sub_compact_states.size(), files_output.size());
+    for (size_t i = 1; i < num_verify_threads; i++) {
       thread_pool.emplace_back(verify_table,
                                std::ref(compact_->sub_compact_states[i].status));
     }
@@ -545,6 +840,13 @@ Status CompactionJob::Run() {
     for (auto& thread : thread_pool) {
       thread.join();
     }
+    dir_fsync_thread.join();
+    if (io_status_.ok()) {
+      io_status_ = io_s;
+    }
+    if (status.ok()) {
+      status = io_s;
+    }
     for (const auto& state : compact_->sub_compact_states) {
       if (!state.status.ok()) {
         status = state.status;
@@ -564,6 +866,27 @@ Status CompactionJob::Run() {
   }
   compact_->compaction->SetOutputTableProperties(std::move(tp));
 
+  // The inputs were streamed through the page cache exactly once and become
+  // obsolete as soon as the result is installed, yet version references can
+  // keep the files on disk (and their pages cached) long after. Advise the
+  // cached pages away now, while no mutex is held; on the off chance the
+  // install fails the only cost is a cold re-read. Direct reads never
+  // populated the cache in the first place.
+  if (status.ok() && !file_options_for_read_.use_direct_reads) {
+    Compaction* c = compact_->compaction;
+    TableCache* table_cache = c->column_family_data()->table_cache();
+    for (size_t input_level = 0; input_level < c->num_input_levels();
+         input_level++) {
+      for (const FileMetaData* f : *c->inputs(input_level)) {
+        table_cache->EvictPageCache(f->fd.GetNumber());
+      }
+    }
+  }
+
+  if (status.ok()) {
+    AggregateBlobFileGarbage();
+  }
+
   // Finish up all book-keeping to unify the subcompaction results
   compact_->AggregateCompactionStats(compaction_stats_, *compaction_job_stats_);
   UpdateCompactionStats();
@@ -846,8 +1169,6 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   auto range_del_agg = std::make_unique<CompactionRangeDelAggregator>(
       &cfd->internal_comparator(), existing_snapshots_);
 
-  // TODO: since we already use C++17, should use
-  // std::optional<const Slice> instead.
   const Slice* const start = sub_compact->start;
   const Slice* const end = sub_compact->end;
 
@@ -871,11 +1192,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // the AddTombstones calls will be propagated down to the v1 aggregator.
   std::unique_ptr<InternalIterator> raw_input(versions_->MakeInputIterator(
       read_options, sub_compact->compaction, range_del_agg.get(),
-      file_options_for_read_,
-      (start == nullptr) ? std::optional<const Slice>{}
-                         : std::optional<const Slice>{*start},
-      (end == nullptr) ? std::optional<const Slice>{}
-                       : std::optional<const Slice>{*end}));
+      file_options_for_read_, start, end));
   InternalIterator* input = raw_input.get();
 
   IterKey start_ikey;
@@ -923,6 +1240,10 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // I/O measurement variables
   PerfLevel prev_perf_level = PerfLevel::kEnableTime;
   const uint64_t kRecordStatsEvery = 1000;
+  // Countdown to the next periodic stats flush; a decrement-and-test is
+  // cheaper than taking num_input_records modulo a non-power-of-two on
+  // every key.
+  uint64_t records_until_stats_flush = kRecordStatsEvery;
   uint64_t prev_write_nanos = 0;
   uint64_t prev_fsync_nanos = 0;
   uint64_t prev_range_sync_nanos = 0;
@@ -968,6 +1289,17 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
                 &blob_file_paths,
                 sub_compact->Current().GetBlobFileAdditionsPtr())
           : nullptr);
+  if (blob_file_builder) {
+    // One entry per blob file produced; reserve from the input size so the
+    // vector does not regrow while the builder appends. Values are only a
+    // part of the input, so cap the (over)estimate.
+    const uint64_t expected_blob_files =
+        sub_compact->compaction->CalculateTotalInputSize() /
+            std::max<uint64_t>(mutable_cf_options->blob_file_size, 1) +
+        1;
+    blob_file_paths.reserve(
+        static_cast<size_t>(std::min<uint64_t>(expected_blob_files, 16)));
+  }
 
   TEST_SYNC_POINT("CompactionJob::Run():Inprogress");
   TEST_SYNC_POINT_CALLBACK(
@@ -1006,12 +1338,13 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   const auto& c_iter_stats = c_iter->iter_stats();
 
   // define the open and close functions for the compaction files, which will be
-  // used open/close output files when needed.
-  const CompactionFileOpenFunc open_file_func =
-      [this, sub_compact](CompactionOutputs& outputs) {
-        return this->OpenCompactionOutputFile(sub_compact, outputs);
-      };
-  const CompactionFileCloseFunc close_file_func =
+  // used open/close output files when needed. The lambdas keep their concrete
+  // types so AddToOutput() inlines them; CloseCompactionFiles() wraps them in
+  // std::function once, off the per-key path.
+  const auto open_file_func = [this, sub_compact](CompactionOutputs& outputs) {
+    return this->OpenCompactionOutputFile(sub_compact, outputs);
+  };
+  const auto close_file_func =
       [this, sub_compact](CompactionOutputs& outputs, const Status& status,
                           const Slice& next_table_min_key) {
         return this->FinishCompactionOutputFile(status, sub_compact, outputs,
@@ -1019,18 +1352,41 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       };
 
   Status status;
-  while (status.ok() && !cfd->IsDropped() && c_iter->Valid()) {
+  // Hoisted invariants for the per-key loop below: the output level and
+  // per-key-placement support cannot change while the subcompaction runs,
+  // and a column family drop is checked at the periodic stats flush (and
+  // again after the loop) instead of with an atomic load per key.
+  const bool check_stop_before =
+      sub_compact->compaction->output_level() != 0 &&
+      !sub_compact->compaction->SupportsPerKeyPlacement();
+  bool cfd_dropped = cfd->IsDropped();
+  // The shared statistics tickers are flushed once when the subcompaction
+  // finishes; the periodic branch below only drains the thread-local I/O
+  // counters into this batch (keeping the live thread status current) so
+  // the hot loop issues no shared-counter updates at all.
+  uint64_t batched_read_bytes = 0;
+  uint64_t batched_write_bytes = 0;
+#ifndef NDEBUG
+  // The per-key upper-bound assertion below dispatches through the virtual
+  // comparator. Detect the built-in bytewise comparator once and compare raw
+  // bytes directly, so debug builds keep the check without paying a virtual
+  // call per key.
+  const Comparator* const assert_ucmp = cfd->user_comparator();
+  const bool assert_bytewise = assert_ucmp == BytewiseComparator();
+#endif
+  while (status.ok() && !cfd_dropped && c_iter->Valid()) {
     // Invariant: c_iter.status() is guaranteed to be OK if c_iter->Valid()
     // returns true.
 
     assert(!end ||
-           cfd->user_comparator()->Compare(c_iter->user_key(), *end) < 0);
-
-    if (c_iter_stats.num_input_records % kRecordStatsEvery ==
-        kRecordStatsEvery - 1) {
-      RecordDroppedKeys(c_iter_stats, &sub_compact->compaction_job_stats);
-      c_iter->ResetRecordCounts();
-      RecordCompactionIOStats();
+           (assert_bytewise
+                ? c_iter->user_key().compare(*end) < 0
+                : assert_ucmp->Compare(c_iter->user_key(), *end) < 0));
+
+    if (--records_until_stats_flush == 0) {
+      cfd_dropped = cfd->IsDropped();
+      GatherCompactionIOStats(batched_read_bytes, batched_write_bytes);
+      records_until_stats_flush = kRecordStatsEvery;
     }
 
     // Add current compaction_iterator key to target compaction output, if the
@@ -1055,9 +1411,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     // TODO: Support earlier file cut for the penultimate level files. Maybe by
     //  moving `ShouldStopBefore()` to `CompactionOutputs` class. Currently
     //  the penultimate level output is only cut when it reaches the size limit.
-    if (!sub_compact->Current().IsPendingClose() &&
-        sub_compact->compaction->output_level() != 0 &&
-        !sub_compact->compaction->SupportsPerKeyPlacement() &&
+    if (check_stop_before && !sub_compact->Current().IsPendingClose() &&
         sub_compact->ShouldStopBefore(c_iter->key())) {
       sub_compact->Current().SetPendingClose();
     }
@@ -1092,8 +1446,13 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
                c_iter_stats.total_blob_bytes_relocated);
   }
 
+  // The drop counters in c_iter_stats are cumulative, so recording them once
+  // here covers the whole subcompaction; the batched I/O bytes gathered in
+  // the loop above are flushed to the shared tickers along with the final
+  // interval.
   RecordDroppedKeys(c_iter_stats, &sub_compact->compaction_job_stats);
-  RecordCompactionIOStats();
+  GatherCompactionIOStats(batched_read_bytes, batched_write_bytes);
+  FlushCompactionIOStats(batched_read_bytes, batched_write_bytes);
 
   if (status.ok() && cfd->IsDropped()) {
     status =
@@ -1114,16 +1473,31 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     status = c_iter->status();
   }
 
+  // The blob file and the SST outputs are independent streams, so their
+  // final write-out and sync can proceed in parallel instead of serializing
+  // the two fsyncs at the tail of the subcompaction. Only worth a thread
+  // when things went well so far; on error the builder is abandoned below.
+  Status blob_finish_status;
+  port::Thread blob_finish_thread;
+  const bool blob_finish_async = blob_file_builder != nullptr && status.ok();
+  if (blob_finish_async) {
+    blob_finish_thread = port::Thread(
+        [&]() { blob_finish_status = blob_file_builder->Finish(); });
+  }
+
   // Call FinishCompactionOutputFile() even if status is not ok: it needs to
   // close the output files. Open file function is also passed, in case there's
   // only range-dels, no file was opened, to save the range-dels, it need to
   // create a new output file.
-  status = sub_compact->CloseCompactionFiles(status, open_file_func,
-                                             close_file_func);
+  status = sub_compact->CloseCompactionFiles(status, job_earliest_snapshot_,
+                                             open_file_func, close_file_func);
 
   if (blob_file_builder) {
-    if (status.ok()) {
-      status = blob_file_builder->Finish();
+    if (blob_finish_async) {
+      blob_finish_thread.join();
+      if (status.ok()) {
+        status = blob_finish_status;
+      }
     } else {
       blob_file_builder->Abandon(status);
     }
@@ -1176,37 +1550,28 @@ uint64_t CompactionJob::GetCompactionId(SubcompactionState* sub_compact) const {
 void CompactionJob::RecordDroppedKeys(
     const CompactionIterationStats& c_iter_stats,
     CompactionJobStats* compaction_job_stats) {
-  if (c_iter_stats.num_record_drop_user > 0) {
-    RecordTick(stats_, COMPACTION_KEY_DROP_USER,
-               c_iter_stats.num_record_drop_user);
-  }
-  if (c_iter_stats.num_record_drop_hidden > 0) {
-    RecordTick(stats_, COMPACTION_KEY_DROP_NEWER_ENTRY,
-               c_iter_stats.num_record_drop_hidden);
-    if (compaction_job_stats) {
-      compaction_job_stats->num_records_replaced +=
-          c_iter_stats.num_record_drop_hidden;
-    }
-  }
-  if (c_iter_stats.num_record_drop_obsolete > 0) {
-    RecordTick(stats_, COMPACTION_KEY_DROP_OBSOLETE,
-               c_iter_stats.num_record_drop_obsolete);
-    if (compaction_job_stats) {
-      compaction_job_stats->num_expired_deletion_records +=
-          c_iter_stats.num_record_drop_obsolete;
-    }
-  }
-  if (c_iter_stats.num_record_drop_range_del > 0) {
-    RecordTick(stats_, COMPACTION_KEY_DROP_RANGE_DEL,
-               c_iter_stats.num_record_drop_range_del);
-  }
-  if (c_iter_stats.num_range_del_drop_obsolete > 0) {
-    RecordTick(stats_, COMPACTION_RANGE_DEL_DROP_OBSOLETE,
-               c_iter_stats.num_range_del_drop_obsolete);
-  }
-  if (c_iter_stats.num_optimized_del_drop_obsolete > 0) {
-    RecordTick(stats_, COMPACTION_OPTIMIZED_DEL_DROP_OBSOLETE,
-               c_iter_stats.num_optimized_del_drop_obsolete);
+  // Walk a flat {ticker, value} array instead of a chain of data-dependent
+  // branches whose outcomes vary per workload; a zero tick on a core-local
+  // counter is cheaper than a mispredict, and adding zero to the job stats
+  // below is free.
+  const std::pair<Tickers, uint64_t> ticks[] = {
+      {COMPACTION_KEY_DROP_USER, c_iter_stats.num_record_drop_user},
+      {COMPACTION_KEY_DROP_NEWER_ENTRY, c_iter_stats.num_record_drop_hidden},
+      {COMPACTION_KEY_DROP_OBSOLETE, c_iter_stats.num_record_drop_obsolete},
+      {COMPACTION_KEY_DROP_RANGE_DEL, c_iter_stats.num_record_drop_range_del},
+      {COMPACTION_RANGE_DEL_DROP_OBSOLETE,
+       c_iter_stats.num_range_del_drop_obsolete},
+      {COMPACTION_OPTIMIZED_DEL_DROP_OBSOLETE,
+       c_iter_stats.num_optimized_del_drop_obsolete},
+  };
+  for (const auto& tick : ticks) {
+    RecordTick(stats_, tick.first, tick.second);
+  }
+  if (compaction_job_stats) {
+    compaction_job_stats->num_records_replaced +=
+        c_iter_stats.num_record_drop_hidden;
+    compaction_job_stats->num_expired_deletion_records +=
+        c_iter_stats.num_record_drop_obsolete;
   }
 }
 
@@ -1222,7 +1587,10 @@ Status CompactionJob::FinishCompactionOutputFile(
   uint64_t output_number = meta->fd.GetNumber();
   assert(output_number != 0);
 
-  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
+  // Resolve the per-job invariants once up front; this function runs once
+  // per output file and previously re-chased these pointers at each use.
+  const Compaction* compaction = sub_compact->compaction;
+  ColumnFamilyData* cfd = compaction->column_family_data();
   std::string file_checksum = kUnknownFileChecksum;
   std::string file_checksum_func_name = kUnknownFileChecksumFuncName;
 
@@ -1230,10 +1598,7 @@ Status CompactionJob::FinishCompactionOutputFile(
   Status s = input_status;
 
   // Add range tombstones
-  auto earliest_snapshot = kMaxSequenceNumber;
-  if (existing_snapshots_.size() > 0) {
-    earliest_snapshot = existing_snapshots_[0];
-  }
+  const SequenceNumber earliest_snapshot = job_earliest_snapshot_;
   if (s.ok()) {
     CompactionIterationStats range_del_out_stats;
     // if the compaction supports per_key_placement, only output range dels to
@@ -1266,8 +1631,8 @@ Status CompactionJob::FinishCompactionOutputFile(
       Slice new_largest = meta->largest.user_key();
       if (!new_largest.empty() && !new_smallest.empty()) {
         refined_oldest_ancester_time =
-            sub_compact->compaction->MinInputFileOldestAncesterTime(
-                &(meta->smallest), &(meta->largest));
+            compaction->MinInputFileOldestAncesterTime(&(meta->smallest),
+                                                       &(meta->largest));
         if (refined_oldest_ancester_time !=
             std::numeric_limits<uint64_t>::max()) {
           meta->oldest_ancester_time = refined_oldest_ancester_time;
@@ -1276,9 +1641,18 @@ Status CompactionJob::FinishCompactionOutputFile(
     }
   }
 
-  // Finish and check for file errors
+  // Finish and check for file errors. Outputs below L2 were written through
+  // the page cache and won't be read again soon, so drop them from the cache
+  // once synced to limit eviction of hot foreground data; flush and L0->L1
+  // outputs stay cached since they are likely to be read or re-compacted
+  // shortly. With direct writes nothing was cached, and with paranoid checks
+  // the verification pass is about to read the file back.
+  const bool drop_page_cache = !file_options_.use_direct_writes &&
+                               !paranoid_file_checks_ &&
+                               compaction->output_level() >= 2;
   IOStatus io_s = outputs.WriterSyncClose(s, db_options_.clock, stats_,
-                                          db_options_.use_fsync);
+                                          db_options_.use_fsync,
+                                          drop_page_cache);
 
   if (s.ok() && io_s.ok()) {
     file_checksum = meta->file_checksum;
@@ -1305,7 +1679,7 @@ Status CompactionJob::FinishCompactionOutputFile(
     // This happens when the output level is bottom level, at the same time
     // the sub_compact output nothing.
     std::string fname =
-        TableFileName(sub_compact->compaction->immutable_options()->cf_paths,
+        TableFileName(compaction->immutable_options()->cf_paths,
                       meta->fd.GetNumber(), meta->fd.GetPathId());
 
     // TODO(AR) it is not clear if there are any larger implications if
@@ -1418,37 +1792,19 @@ Status CompactionJob::InstallCompactionResults(
   // Add compaction inputs
   compaction->AddInputDeletions(edit);
 
-  std::unordered_map<uint64_t, BlobGarbageMeter::BlobStats> blob_total_garbage;
-
   for (const auto& sub_compact : compact_->sub_compact_states) {
     sub_compact.AddOutputsEdit(edit);
 
     for (const auto& blob : sub_compact.Current().GetBlobFileAdditions()) {
       edit->AddBlobFile(blob);
     }
-
-    if (sub_compact.Current().GetBlobGarbageMeter()) {
-      const auto& flows = sub_compact.Current().GetBlobGarbageMeter()->flows();
-
-      for (const auto& pair : flows) {
-        const uint64_t blob_file_number = pair.first;
-        const BlobGarbageMeter::BlobInOutFlow& flow = pair.second;
-
-        assert(flow.IsValid());
-        if (flow.HasGarbage()) {
-          blob_total_garbage[blob_file_number].Add(flow.GetGarbageCount(),
-                                                   flow.GetGarbageBytes());
-        }
-      }
-    }
   }
 
-  for (const auto& pair : blob_total_garbage) {
-    const uint64_t blob_file_number = pair.first;
-    const BlobGarbageMeter::BlobStats& stats = pair.second;
-
-    edit->AddBlobFileGarbage(blob_file_number, stats.GetCount(),
-                             stats.GetBytes());
+  // Per-file blob garbage totals were aggregated at the end of Run(), off
+  // the DB mutex; only the transcription into the edit happens here.
+  for (const auto& garbage : blob_file_garbage_) {
+    edit->AddBlobFileGarbage(std::get<0>(garbage), std::get<1>(garbage),
+                             std::get<2>(garbage));
   }
 
   if (compaction->compaction_reason() == CompactionReason::kLevelMaxLevelSize &&
@@ -1466,38 +1822,114 @@ Status CompactionJob::InstallCompactionResults(
                                 db_directory_);
 }
 
+void CompactionJob::AggregateBlobFileGarbage() {
+  assert(blob_file_garbage_.empty());
+
+  // Collect (blob file number, garbage count, garbage bytes) triples into a
+  // flat vector and aggregate per blob file with a sort and one linear
+  // group-by pass: contiguous traversal, no rehashing, and the edit entries
+  // come out ordered by file number.
+  std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> blob_garbage_entries;
+
+  for (const auto& sub_compact : compact_->sub_compact_states) {
+    if (!sub_compact.Current().GetBlobGarbageMeter()) {
+      continue;
+    }
+
+    const auto& flows = sub_compact.Current().GetBlobGarbageMeter()->flows();
+
+    blob_garbage_entries.reserve(blob_garbage_entries.size() + flows.size());
+    for (const auto& pair : flows) {
+      const uint64_t blob_file_number = pair.first;
+      const BlobGarbageMeter::BlobInOutFlow& flow = pair.second;
+
+      assert(flow.IsValid());
+      if (flow.HasGarbage()) {
+        blob_garbage_entries.emplace_back(
+            blob_file_number, flow.GetGarbageCount(), flow.GetGarbageBytes());
+      }
+    }
+  }
+
+  if (blob_garbage_entries.empty()) {
+    return;
+  }
+
+  std::sort(blob_garbage_entries.begin(), blob_garbage_entries.end());
+  for (size_t i = 0; i < blob_garbage_entries.size();) {
+    const uint64_t blob_file_number = std::get<0>(blob_garbage_entries[i]);
+    uint64_t garbage_count = 0;
+    uint64_t garbage_bytes = 0;
+    do {
+      garbage_count += std::get<1>(blob_garbage_entries[i]);
+      garbage_bytes += std::get<2>(blob_garbage_entries[i]);
+      ++i;
+    } while (i < blob_garbage_entries.size() &&
+             std::get<0>(blob_garbage_entries[i]) == blob_file_number);
+    blob_file_garbage_.emplace_back(blob_file_number, garbage_count,
+                                    garbage_bytes);
+  }
+}
+
 void CompactionJob::RecordCompactionIOStats() {
-  RecordTick(stats_, COMPACT_READ_BYTES, IOSTATS(bytes_read));
-  RecordTick(stats_, COMPACT_WRITE_BYTES, IOSTATS(bytes_written));
+  uint64_t read_bytes = 0;
+  uint64_t write_bytes = 0;
+  GatherCompactionIOStats(read_bytes, write_bytes);
+  FlushCompactionIOStats(read_bytes, write_bytes);
+}
+
+void CompactionJob::GatherCompactionIOStats(uint64_t& read_bytes,
+                                            uint64_t& write_bytes) {
+  // Snapshot the thread-local counters once instead of re-reading them for
+  // every consumer.
+  const uint64_t bytes_read = IOSTATS(bytes_read);
+  const uint64_t bytes_written = IOSTATS(bytes_written);
+  IOSTATS_RESET(bytes_read);
+  IOSTATS_RESET(bytes_written);
+  read_bytes += bytes_read;
+  write_bytes += bytes_written;
+  // Keep the live thread status current even while the shared tickers are
+  // deferred; these are relaxed stores on the thread-local status object.
+  ThreadStatusUtil::IncreaseThreadOperationProperty(
+      ThreadStatus::COMPACTION_BYTES_READ, bytes_read);
+  ThreadStatusUtil::IncreaseThreadOperationProperty(
+      ThreadStatus::COMPACTION_BYTES_WRITTEN, bytes_written);
+}
+
+void CompactionJob::FlushCompactionIOStats(uint64_t read_bytes,
+                                           uint64_t write_bytes) {
+  if (read_bytes == 0 && write_bytes == 0) {
+    return;
+  }
+  RecordTick(stats_, COMPACT_READ_BYTES, read_bytes);
+  RecordTick(stats_, COMPACT_WRITE_BYTES, write_bytes);
   CompactionReason compaction_reason =
       compact_->compaction->compaction_reason();
   if (compaction_reason == CompactionReason::kFilesMarkedForCompaction) {
-    RecordTick(stats_, COMPACT_READ_BYTES_MARKED, IOSTATS(bytes_read));
-    RecordTick(stats_, COMPACT_WRITE_BYTES_MARKED, IOSTATS(bytes_written));
+    RecordTick(stats_, COMPACT_READ_BYTES_MARKED, read_bytes);
+    RecordTick(stats_, COMPACT_WRITE_BYTES_MARKED, write_bytes);
   } else if (compaction_reason == CompactionReason::kPeriodicCompaction) {
-    RecordTick(stats_, COMPACT_READ_BYTES_PERIODIC, IOSTATS(bytes_read));
-    RecordTick(stats_, COMPACT_WRITE_BYTES_PERIODIC, IOSTATS(bytes_written));
+    RecordTick(stats_, COMPACT_READ_BYTES_PERIODIC, read_bytes);
+    RecordTick(stats_, COMPACT_WRITE_BYTES_PERIODIC, write_bytes);
   } else if (compaction_reason == CompactionReason::kTtl) {
-    RecordTick(stats_, COMPACT_READ_BYTES_TTL, IOSTATS(bytes_read));
-    RecordTick(stats_, COMPACT_WRITE_BYTES_TTL, IOSTATS(bytes_written));
+    RecordTick(stats_, COMPACT_READ_BYTES_TTL, read_bytes);
+    RecordTick(stats_, COMPACT_WRITE_BYTES_TTL, write_bytes);
   }
-  ThreadStatusUtil::IncreaseThreadOperationProperty(
-      ThreadStatus::COMPACTION_BYTES_READ, IOSTATS(bytes_read));
-  IOSTATS_RESET(bytes_read);
-  ThreadStatusUtil::IncreaseThreadOperationProperty(
-      ThreadStatus::COMPACTION_BYTES_WRITTEN, IOSTATS(bytes_written));
-  IOSTATS_RESET(bytes_written);
 }
 
 Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
                                                CompactionOutputs& outputs) {
   assert(sub_compact != nullptr);
 
+  // Per-job invariants used throughout; resolve them once instead of
+  // chasing sub_compact->compaction at every use.
+  const Compaction* compaction = sub_compact->compaction;
+  ColumnFamilyData* cfd = compaction->column_family_data();
+
   // no need to lock because VersionSet::next_file_number_ is atomic
   uint64_t file_number = versions_->NewFileNumber();
   std::string fname = GetTableFileName(file_number);
   // Fire events.
-  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
 #ifndef ROCKSDB_LITE
   EventHelpers::NotifyTableFileCreationStarted(
       cfd->ioptions()->listeners, dbname_, cfd->GetName(), fname, job_id_,
@@ -1511,14 +1943,14 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
                            &syncpoint_arg);
 #endif
 
-  // Pass temperature of botommost files to FileSystem.
+  // Pass temperature of botommost files to FileSystem. The bottommost
+  // fallback is resolved once per job; only the penultimate-vs-last level
+  // choice can change between output files under per-key placement.
   FileOptions fo_copy = file_options_;
-  Temperature temperature = sub_compact->compaction->output_temperature();
-  if (temperature == Temperature::kUnknown && bottommost_level_ &&
-      !sub_compact->IsCurrentPenultimateLevel()) {
-    temperature =
-        sub_compact->compaction->mutable_cf_options()->bottommost_temperature;
-  }
+  const Temperature temperature =
+      sub_compact->IsCurrentPenultimateLevel()
+          ? compaction->output_temperature()
+          : resolved_output_temperature_;
   fo_copy.temperature = temperature;
 
   Status s;
@@ -1535,8 +1967,7 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
         db_options_.info_log,
         "[%s] [JOB %d] OpenCompactionOutputFiles for table #%" PRIu64
         " fails at NewWritableFile with status %s",
-        sub_compact->compaction->column_family_data()->GetName().c_str(),
-        job_id_, file_number, s.ToString().c_str());
+        cfd->GetName().c_str(), job_id_, file_number, s.ToString().c_str());
     LogFlush(db_options_.info_log);
     EventHelpers::LogAndNotifyTableFileCreationFinished(
         event_logger_, cfd->ioptions()->listeners, dbname_, cfd->GetName(),
@@ -1546,27 +1977,38 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
     return s;
   }
 
-  // Try to figure out the output file's oldest ancester time.
-  int64_t temp_current_time = 0;
-  auto get_time_status = db_options_.clock->GetCurrentTime(&temp_current_time);
-  // Safe to proceed even if GetCurrentTime fails. So, log and proceed.
-  if (!get_time_status.ok()) {
-    ROCKS_LOG_WARN(db_options_.info_log,
-                   "Failed to get current time. Status: %s",
-                   get_time_status.ToString().c_str());
-  }
-  uint64_t current_time = static_cast<uint64_t>(temp_current_time);
-  InternalKey tmp_start, tmp_end;
-  if (sub_compact->start != nullptr) {
-    tmp_start.SetMinPossibleForUserKey(*(sub_compact->start));
+  // Try to figure out the output file's oldest ancester time. The clock is
+  // queried once per subcompaction and the result shared by all of its
+  // output files; creation times have second granularity, so re-reading the
+  // clock per file bought nothing.
+  if (sub_compact->cached_wall_time == 0) {
+    int64_t temp_current_time = 0;
+    auto get_time_status =
+        db_options_.clock->GetCurrentTime(&temp_current_time);
+    // Safe to proceed even if GetCurrentTime fails. So, log and proceed.
+    if (!get_time_status.ok()) {
+      ROCKS_LOG_WARN(db_options_.info_log,
+                     "Failed to get current time. Status: %s",
+                     get_time_status.ToString().c_str());
+    }
+    sub_compact->cached_wall_time = static_cast<uint64_t>(temp_current_time);
   }
-  if (sub_compact->end != nullptr) {
-    tmp_end.SetMinPossibleForUserKey(*(sub_compact->end));
+  const uint64_t current_time = sub_compact->cached_wall_time;
+  if (!sub_compact->min_oldest_ancester_time_resolved) {
+    InternalKey tmp_start, tmp_end;
+    if (sub_compact->start != nullptr) {
+      tmp_start.SetMinPossibleForUserKey(*(sub_compact->start));
+    }
+    if (sub_compact->end != nullptr) {
+      tmp_end.SetMinPossibleForUserKey(*(sub_compact->end));
+    }
+    sub_compact->min_oldest_ancester_time =
+        compaction->MinInputFileOldestAncesterTime(
+            (sub_compact->start != nullptr) ? &tmp_start : nullptr,
+            (sub_compact->end != nullptr) ? &tmp_end : nullptr);
+    sub_compact->min_oldest_ancester_time_resolved = true;
   }
-  uint64_t oldest_ancester_time =
-      sub_compact->compaction->MinInputFileOldestAncesterTime(
-          (sub_compact->start != nullptr) ? &tmp_start : nullptr,
-          (sub_compact->end != nullptr) ? &tmp_end : nullptr);
+  uint64_t oldest_ancester_time = sub_compact->min_oldest_ancester_time;
   if (oldest_ancester_time == std::numeric_limits<uint64_t>::max()) {
     oldest_ancester_time = current_time;
   }
@@ -1574,15 +2016,22 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
   // Initialize a SubcompactionState::Output and add it to sub_compact->outputs
   {
     FileMetaData meta;
-    meta.fd = FileDescriptor(file_number,
-                             sub_compact->compaction->output_path_id(), 0);
+    meta.fd = FileDescriptor(file_number, compaction->output_path_id(), 0);
     meta.oldest_ancester_time = oldest_ancester_time;
     meta.file_creation_time = current_time;
     meta.temperature = temperature;
     assert(!db_id_.empty());
     assert(!db_session_id_.empty());
-    s = GetSstInternalUniqueId(db_id_, db_session_id_, meta.fd.GetNumber(),
-                               &meta.unique_id);
+    if (unique_id_prefix_valid_) {
+      s = GetSstInternalUniqueIdFromPrefix(unique_id_prefix_,
+                                           meta.fd.GetNumber(),
+                                           &meta.unique_id);
+    } else {
+      // Fall back to the full computation so the error message reflects
+      // what is actually wrong with the ids.
+      s = GetSstInternalUniqueId(db_id_, db_session_id_, meta.fd.GetNumber(),
+                                 &meta.unique_id);
+    }
     if (!s.ok()) {
       ROCKS_LOG_ERROR(db_options_.info_log,
                       "[%s] [JOB %d] file #%" PRIu64
@@ -1592,38 +2041,43 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
       return s;
     }
 
-    outputs.AddOutput(std::move(meta), cfd->internal_comparator(),
-                      sub_compact->compaction->mutable_cf_options()
-                          ->check_flush_compaction_key_order,
-                      paranoid_file_checks_);
+    outputs.AddOutput(
+        std::move(meta), cfd->internal_comparator(),
+        compaction->mutable_cf_options()->check_flush_compaction_key_order,
+        paranoid_file_checks_);
   }
 
   writable_file->SetIOPriority(GetRateLimiterPriority());
   writable_file->SetWriteLifeTimeHint(write_hint_);
   FileTypeSet tmp_set = db_options_.checksum_handoff_file_types;
-  writable_file->SetPreallocationBlockSize(static_cast<size_t>(
-      sub_compact->compaction->OutputFilePreallocationSize()));
-  const auto& listeners =
-      sub_compact->compaction->immutable_options()->listeners;
+  writable_file->SetPreallocationBlockSize(
+      static_cast<size_t>(output_file_preallocation_size_));
+  const auto& listeners = compaction->immutable_options()->listeners;
   outputs.AssignFileWriter(new WritableFileWriter(
       std::move(writable_file), fname, fo_copy, db_options_.clock, io_tracer_,
       db_options_.stats, listeners, db_options_.file_checksum_gen_factory.get(),
       tmp_set.Contains(FileType::kTableFile), false));
 
+  // Same gating as the close-time page-cache drop in
+  // FinishCompactionOutputFile: direct writes bypass the cache entirely and
+  // paranoid checks re-read the file right after it is finished.
+  outputs.SetEvictPageCacheOnWrite(!fo_copy.use_direct_writes &&
+                                   !paranoid_file_checks_ &&
+                                   compaction->output_level() >= 2);
+
   TableBuilderOptions tboptions(
-      *cfd->ioptions(), *(sub_compact->compaction->mutable_cf_options()),
+      *cfd->ioptions(), *(compaction->mutable_cf_options()),
       cfd->internal_comparator(), cfd->int_tbl_prop_collector_factories(),
-      sub_compact->compaction->output_compression(),
-      sub_compact->compaction->output_compression_opts(), cfd->GetID(),
-      cfd->GetName(), sub_compact->compaction->output_level(),
+      compaction->output_compression(),
+      compaction->output_compression_opts(), cfd->GetID(),
+      cfd->GetName(), compaction->output_level(),
       bottommost_level_, TableFileCreationReason::kCompaction,
       oldest_ancester_time, 0 /* oldest_key_time */, current_time, db_id_,
-      db_session_id_, sub_compact->compaction->max_output_file_size(),
+      db_session_id_, compaction->max_output_file_size(),
       file_number);
 
   outputs.NewBuilder(tboptions);
 
-  LogFlush(db_options_.info_log);
   return s;
 }
 
@@ -1678,15 +2132,20 @@ void CompactionJob::UpdateCompactionInputStatsHelper(int* num_files,
                                                      uint64_t* bytes_read,
                                                      int input_level) {
   const Compaction* compaction = compact_->compaction;
-  auto num_input_files = compaction->num_input_files(input_level);
-  *num_files += static_cast<int>(num_input_files);
-
-  for (size_t i = 0; i < num_input_files; ++i) {
-    const auto* file_meta = compaction->input(input_level, i);
-    *bytes_read += file_meta->fd.GetFileSize();
-    compaction_stats_.stats.num_input_records +=
-        static_cast<uint64_t>(file_meta->num_entries);
-  }
+  const std::vector<FileMetaData*>& files = *compaction->inputs(input_level);
+  *num_files += static_cast<int>(files.size());
+
+  // Accumulate into locals so the sums stay in registers over the scan
+  // (letting the compiler unroll/vectorize it) instead of read-modify-writing
+  // through the out-pointers once per file.
+  uint64_t bytes = 0;
+  uint64_t records = 0;
+  for (const FileMetaData* file_meta : files) {
+    bytes += file_meta->fd.GetFileSize();
+    records += static_cast<uint64_t>(file_meta->num_entries);
+  }
+  *bytes_read += bytes;
+  compaction_stats_.stats.num_input_records += records;
 }
 
 void CompactionJob::UpdateCompactionJobStats(
@@ -1745,8 +2204,11 @@ void CompactionJob::LogCompaction() {
            << "compaction_started"
            << "compaction_reason"
            << GetCompactionReasonString(compaction->compaction_reason());
+    char files_key[16];
     for (size_t i = 0; i < compaction->num_input_levels(); ++i) {
-      stream << ("files_L" + std::to_string(compaction->level(i)));
+      snprintf(files_key, sizeof(files_key), "files_L%d",
+               compaction->level(i));
+      stream << files_key;
       stream.StartArray();
       for (auto f : *compaction->inputs(i)) {
         stream << f->fd.GetNumber();
@@ -1764,13 +2226,9 @@ std::string CompactionJob::GetTableFileName(uint64_t file_number) {
 }
 
 Env::IOPriority CompactionJob::GetRateLimiterPriority() {
-  if (versions_ && versions_->GetColumnFamilySet() &&
-      versions_->GetColumnFamilySet()->write_controller()) {
-    WriteController* write_controller =
-        versions_->GetColumnFamilySet()->write_controller();
-    if (write_controller->NeedsDelay() || write_controller->IsStopped()) {
-      return Env::IO_USER;
-    }
+  if (write_controller_ != nullptr &&
+      (write_controller_->NeedsDelay() || write_controller_->IsStopped())) {
+    return Env::IO_USER;
   }
 
   return Env::IO_LOW;
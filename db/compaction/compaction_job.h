@@ -41,6 +41,7 @@
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/transaction_log.h"
 #include "table/scoped_arena_iterator.h"
+#include "table/unique_id_impl.h"
 #include "util/autovector.h"
 #include "util/stop_watch.h"
 #include "util/thread_local.h"
@@ -192,6 +193,14 @@ class CompactionJob {
   void UpdateCompactionStats();
   void LogCompaction();
   virtual void RecordCompactionIOStats();
+  // Drains the thread-local I/O byte counters into the given accumulators
+  // and updates the live thread status, without touching the shared
+  // statistics tickers; FlushCompactionIOStats records the accumulated
+  // totals there. RecordCompactionIOStats composes the two for callers
+  // outside the per-key loop.
+  virtual void GatherCompactionIOStats(uint64_t& read_bytes,
+                                       uint64_t& write_bytes);
+  void FlushCompactionIOStats(uint64_t read_bytes, uint64_t write_bytes);
   void CleanupCompaction();
 
   // Call compaction filter. Then iterate through input and compact the
@@ -207,6 +216,15 @@ class CompactionJob {
   Statistics* stats_;
   // Is this compaction creating a file in the bottom most level?
   bool bottommost_level_;
+  // Output temperature with the bottommost fallback already applied;
+  // resolved alongside bottommost_level_ (ResolveOutputTemperature()) so
+  // the per-file open path does not re-derive it. Penultimate-level outputs
+  // keep the compaction's own setting.
+  Temperature resolved_output_temperature_ = Temperature::kUnknown;
+
+  // Applies the bottommost_temperature fallback to the compaction's output
+  // temperature; must run after bottommost_level_ is set.
+  void ResolveOutputTemperature();
 
   Env::WriteLifeTimeHint write_hint_;
 
@@ -221,8 +239,10 @@ class CompactionJob {
   // the input. It adds the starting and/or ending keys of certain input files
   // to the working set and then finds the approximate size of data in between
   // each consecutive pair of slices. Then it divides these ranges into
-  // consecutive groups such that each group has a similar size.
-  void GenSubcompactionBoundaries();
+  // consecutive groups such that each group has a similar size. The returned
+  // Slices point into the input files' metadata; each SubcompactionState
+  // copies its own boundary bytes out of them in Prepare().
+  autovector<Slice, 16> GenSubcompactionBoundaries();
 
   CompactionServiceJobStatus ProcessKeyValueCompactionWithCompactionService(
       SubcompactionState* sub_compact);
@@ -235,6 +255,11 @@ class CompactionJob {
                                     CompactionOutputs& outputs,
                                     const Slice& next_table_min_key);
   Status InstallCompactionResults(const MutableCFOptions& mutable_cf_options);
+  // Aggregates the blob garbage flows of all subcompactions into
+  // blob_file_garbage_. Runs at the end of Run(), off the DB mutex, so
+  // InstallCompactionResults() only has to transcribe the per-file totals
+  // into the version edit.
+  void AggregateBlobFileGarbage();
   Status OpenCompactionOutputFile(SubcompactionState* sub_compact,
                                   CompactionOutputs& outputs);
   void UpdateCompactionJobStats(
@@ -249,53 +274,69 @@ class CompactionJob {
 
   void NotifyOnSubcompactionCompleted(SubcompactionState* sub_compact);
 
+  // Hot pointers touched by every subcompaction are grouped first so they
+  // share the leading cache lines of the object instead of being interleaved
+  // with the cold configuration strings below.
+  VersionSet* versions_;
+  Env* env_;
+  FileSystemPtr fs_;
+  InstrumentedMutex* db_mutex_;
+  ErrorHandler* db_error_handler_;
+  FSDirectory* db_directory_;
+  FSDirectory* blob_output_directory_;
+  const std::atomic<bool>* shutting_down_;
+  const std::atomic<bool>& manual_compaction_canceled_;
+  const SnapshotChecker* const snapshot_checker_;
+  JobContext* job_context_;
+  EventLogger* event_logger_;
+  BlobFileCompletionCallback* blob_callback_;
+
+  // Small POD state.
   uint32_t job_id_;
+  // This is the earliest snapshot that could be used for write-conflict
+  // checking by a transaction.  For any user-key newer than this snapshot, we
+  // should make sure not to remove evidence that a write occurred.
+  SequenceNumber earliest_write_conflict_snapshot_;
+  bool paranoid_file_checks_;
+  bool measure_io_stats_;
+  Env::Priority thread_pri_;
 
-  // DBImpl state
+  // Cold, mostly-configuration DBImpl state: consulted at setup/teardown or
+  // per output file, not per key.
   const std::string& dbname_;
   const std::string db_id_;
   const std::string db_session_id_;
   const FileOptions file_options_;
-
-  Env* env_;
-  std::shared_ptr<IOTracer> io_tracer_;
-  FileSystemPtr fs_;
   // env_option optimized for compaction table reads
   FileOptions file_options_for_read_;
-  VersionSet* versions_;
-  const std::atomic<bool>* shutting_down_;
-  const std::atomic<bool>& manual_compaction_canceled_;
-  FSDirectory* db_directory_;
-  FSDirectory* blob_output_directory_;
-  InstrumentedMutex* db_mutex_;
-  ErrorHandler* db_error_handler_;
+  std::shared_ptr<IOTracer> io_tracer_;
   // If there were two snapshots with seq numbers s1 and
   // s2 and s1 < s2, and if we find two instances of a key k1 then lies
   // entirely within s1 and s2, then the earlier version of k1 can be safely
   // deleted because that version is not visible in any snapshot.
   std::vector<SequenceNumber> existing_snapshots_;
-
-  // This is the earliest snapshot that could be used for write-conflict
-  // checking by a transaction.  For any user-key newer than this snapshot, we
-  // should make sure not to remove evidence that a write occurred.
-  SequenceNumber earliest_write_conflict_snapshot_;
-
-  const SnapshotChecker* const snapshot_checker_;
-
-  JobContext* job_context_;
-
+  // The earliest snapshot in existing_snapshots_, or kMaxSequenceNumber when
+  // there is none; resolved once here instead of per output file.
+  SequenceNumber job_earliest_snapshot_;
   std::shared_ptr<Cache> table_cache_;
-
-  EventLogger* event_logger_;
-
-  bool paranoid_file_checks_;
-  bool measure_io_stats_;
-  // Stores the Slices that designate the boundaries for each subcompaction
-  std::vector<Slice> boundaries_;
-  Env::Priority thread_pri_;
+  // Cached from versions_->GetColumnFamilySet() at construction so
+  // GetRateLimiterPriority() only reads the controller's atomic state per
+  // call instead of re-chasing the pointers. May be nullptr in tests.
+  WriteController* write_controller_ = nullptr;
   std::string full_history_ts_low_;
   std::string trim_ts_;
-  BlobFileCompletionCallback* blob_callback_;
+  // Computed once at construction; OutputFilePreallocationSize() walks every
+  // input file, so it is not re-derived for each output file opened.
+  const uint64_t output_file_preallocation_size_;
+  // db_id_/db_session_id_-dependent portion of the SST unique id, computed
+  // once per job; per-file ids only fold in the file number. When invalid
+  // the per-file path falls back to the full computation so the error
+  // surfaces with its original message.
+  UniqueId64x3 unique_id_prefix_{};
+  bool unique_id_prefix_valid_ = false;
+  // (blob file number, garbage count, garbage bytes), one entry per blob
+  // file, sorted by file number; see AggregateBlobFileGarbage().
+  std::vector<std::tuple<uint64_t, uint64_t, uint64_t>> blob_file_garbage_;
 
   uint64_t GetCompactionId(SubcompactionState* sub_compact) const;
 
@@ -436,7 +477,8 @@ class CompactionServiceCompactionJob : private CompactionJob {
   IOStatus io_status() const { return CompactionJob::io_status(); }
 
  protected:
-  void RecordCompactionIOStats() override;
+  void GatherCompactionIOStats(uint64_t& read_bytes,
+                               uint64_t& write_bytes) override;
 
  private:
   // Get table file name in output_path
@@ -48,12 +48,19 @@ Status CompactionOutputs::Finish(const Status& intput_status) {
 IOStatus CompactionOutputs::WriterSyncClose(const Status& input_status,
                                             SystemClock* clock,
                                             Statistics* statistics,
-                                            bool use_fsync) {
+                                            bool use_fsync,
+                                            bool drop_page_cache) {
   IOStatus io_s;
   if (input_status.ok()) {
     StopWatch sw(clock, statistics, COMPACTION_OUTFILE_SYNC_MICROS);
     io_s = file_writer_->Sync(use_fsync);
   }
+  if (input_status.ok() && io_s.ok() && drop_page_cache) {
+    // Compaction outputs are written once and rarely read back soon; now
+    // that the data is durable the cached pages are only evicting hotter
+    // foreground data. A failed advise is harmless.
+    file_writer_->InvalidateCache(0, 0).PermitUncheckedError();
+  }
   if (input_status.ok() && io_s.ok()) {
     io_s = file_writer_->Close();
   }
@@ -69,79 +76,34 @@ IOStatus CompactionOutputs::WriterSyncClose(const Status& input_status,
   return io_s;
 }
 
-Status CompactionOutputs::AddToOutput(
-    const CompactionIterator& c_iter,
-    const CompactionFileOpenFunc& open_file_func,
-    const CompactionFileCloseFunc& close_file_func) {
-  Status s;
-  const Slice& key = c_iter.key();
-
-  if (!pending_close_ && c_iter.Valid() && partitioner_ && HasBuilder() &&
-      partitioner_->ShouldPartition(
-          PartitionerRequest(last_key_for_partitioner_, c_iter.user_key(),
-                             current_output_file_size_)) == kRequired) {
-    pending_close_ = true;
-  }
-
-  if (pending_close_) {
-    s = close_file_func(*this, c_iter.InputStatus(), key);
-    pending_close_ = false;
-  }
-  if (!s.ok()) {
-    return s;
-  }
-
-  // Open output file if necessary
-  if (!HasBuilder()) {
-    s = open_file_func(*this);
-  }
-  if (!s.ok()) {
-    return s;
-  }
-
-  Output& curr = current_output();
-  assert(builder_ != nullptr);
-  const Slice& value = c_iter.value();
-  s = curr.validator.Add(key, value);
-  if (!s.ok()) {
-    return s;
-  }
-  builder_->Add(key, value);
-
-  stats_.num_output_records++;
-  current_output_file_size_ = builder_->EstimatedFileSize();
-
-  if (blob_garbage_meter_) {
-    s = blob_garbage_meter_->ProcessOutFlow(key, value);
-  }
-
-  if (!s.ok()) {
-    return s;
+bool CompactionOutputs::RangeDelsAllObsolete(
+    const Slice* comp_start, const Slice* comp_end,
+    SequenceNumber earliest_snapshot) const {
+  assert(HasRangeDel());
+  if (!compaction_->bottommost_level()) {
+    // Tombstones are only dropped at the bottommost level.
+    return false;
   }
-
-  const ParsedInternalKey& ikey = c_iter.ikey();
-  s = current_output().meta.UpdateBoundaries(key, value, ikey.sequence,
-                                             ikey.type);
-
-  // Close output file if it is big enough. Two possibilities determine it's
-  // time to close it: (1) the current key should be this file's last key, (2)
-  // the next key should not be in this file.
-  //
-  // TODO(aekmekji): determine if file should be closed earlier than this
-  // during subcompactions (i.e. if output size, estimated by input size, is
-  // going to be 1.2MB and max_output_file_size = 1MB, prefer to have 0.6MB
-  // and 0.6MB instead of 1MB and 0.2MB)
-  if (compaction_->output_level() != 0 &&
-      current_output_file_size_ >= compaction_->max_output_file_size()) {
-    pending_close_ = true;
+  const Comparator* ucmp = compaction_->immutable_options()->user_comparator;
+  auto it = range_del_agg_->NewIterator(comp_start, comp_end,
+                                        false /* has_overlapping_endpoints */);
+  if (comp_start != nullptr) {
+    it->Seek(*comp_start);
+  } else {
+    it->SeekToFirst();
   }
-
-  if (partitioner_) {
-    last_key_for_partitioner_.assign(c_iter.user_key().data_,
-                                     c_iter.user_key().size_);
+  for (; it->Valid(); it->Next()) {
+    auto tombstone = it->Tombstone();
+    if (comp_end != nullptr &&
+        ucmp->Compare(*comp_end, tombstone.start_key_) <= 0) {
+      break;
+    }
+    if (tombstone.seq_ > earliest_snapshot) {
+      // Still visible to a snapshot, so AddRangeDels() would write it out.
+      return false;
+    }
   }
-
-  return s;
+  return true;
 }
 
 Status CompactionOutputs::AddRangeDels(
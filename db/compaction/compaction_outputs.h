@@ -50,6 +50,19 @@ class CompactionOutputs {
     partitioner_ = compaction->output_level() == 0
                        ? nullptr
                        : compaction->CreateSstPartitioner();
+
+    // Size the outputs list from the input so it does not regrow once per
+    // added file; capped since the whole input may be split over several
+    // subcompactions. The penultimate-level outputs stay empty for most
+    // compactions, so don't reserve for those.
+    if (!is_penultimate_level && compaction->max_output_file_size() > 0) {
+      const uint64_t expected_outputs =
+          compaction->CalculateTotalInputSize() /
+              compaction->max_output_file_size() +
+          1;
+      outputs_.reserve(
+          static_cast<size_t>(std::min<uint64_t>(expected_outputs, 16)));
+    }
   }
 
   // Add generated output to the list
@@ -66,6 +79,7 @@ class CompactionOutputs {
   // Assign a new WritableFileWriter to the current output
   void AssignFileWriter(WritableFileWriter* writer) {
     file_writer_.reset(writer);
+    last_cache_evict_offset_ = 0;
   }
 
   // TODO: Remove it when remote compaction support tiered compaction
@@ -119,8 +133,12 @@ class CompactionOutputs {
         std::make_shared<TableProperties>(GetTableProperties());
   }
 
+  // If `drop_page_cache` is set, the synced file is dropped from the OS page
+  // cache before closing, so large compactions don't evict hot foreground
+  // data that is still being served from the cache.
   IOStatus WriterSyncClose(const Status& intput_status, SystemClock* clock,
-                           Statistics* statistics, bool use_fsync);
+                           Statistics* statistics, bool use_fsync,
+                           bool drop_page_cache = false);
 
   TableProperties GetTableProperties() {
     return builder_->GetTableProperties();
@@ -184,11 +202,24 @@ class CompactionOutputs {
   // Current file should close before adding a new key
   void SetPendingClose() { pending_close_ = true; }
 
+  // Enable dropping already-written ranges of the current output file from
+  // the OS page cache while it is still being built (see AddToOutput()).
+  void SetEvictPageCacheOnWrite(bool evict) {
+    evict_page_cache_on_write_ = evict;
+  }
+
   // if the outputs have range delete, range delete is also data
   bool HasRangeDel() const {
     return range_del_agg_ && !range_del_agg_->IsEmpty();
   }
 
+  // Whether AddRangeDels() would drop every tombstone in
+  // [comp_start, comp_end): bottommost-level output with all fragments
+  // visible to `earliest_snapshot`. Lets CloseOutput() skip opening a
+  // range-del-only file that would be finished empty and unlinked again.
+  bool RangeDelsAllObsolete(const Slice* comp_start, const Slice* comp_end,
+                            SequenceNumber earliest_snapshot) const;
+
  private:
   friend class SubcompactionState;
 
@@ -206,18 +237,26 @@ class CompactionOutputs {
 
   // Add curent key from compaction_iterator to the output file. If needed
   // close and open new compaction output with the functions provided.
+  // Templated on the callable types so the per-key call chain stays concrete
+  // and inlinable instead of indirecting through std::function; the cold
+  // close path (CloseOutput) keeps the type-erased signatures.
+  template <typename OpenFn, typename CloseFn>
   Status AddToOutput(const CompactionIterator& c_iter,
-                     const CompactionFileOpenFunc& open_file_func,
-                     const CompactionFileCloseFunc& close_file_func);
+                     const OpenFn& open_file_func,
+                     const CloseFn& close_file_func);
 
   // Close the current output. `open_file_func` is needed for creating new file
-  // for range-dels only output file.
-  Status CloseOutput(const Status& curr_status,
+  // for range-dels only output file. `comp_start`/`comp_end` and
+  // `earliest_snapshot` are only consulted for that case, to avoid creating
+  // a file whose tombstones would all be dropped as obsolete anyway.
+  Status CloseOutput(const Status& curr_status, const Slice* comp_start,
+                     const Slice* comp_end, SequenceNumber earliest_snapshot,
                      const CompactionFileOpenFunc& open_file_func,
                      const CompactionFileCloseFunc& close_file_func) {
     Status status = curr_status;
     // handle subcompaction containing only range deletions
-    if (status.ok() && !HasBuilder() && !HasOutput() && HasRangeDel()) {
+    if (status.ok() && !HasBuilder() && !HasOutput() && HasRangeDel() &&
+        !RangeDelsAllObsolete(comp_start, comp_end, earliest_snapshot)) {
       status = open_file_func(*this);
     }
     if (HasBuilder()) {
@@ -263,6 +302,10 @@ class CompactionOutputs {
   std::unique_ptr<WritableFileWriter> file_writer_;
   uint64_t current_output_file_size_ = 0;
 
+  // see SetEvictPageCacheOnWrite()
+  bool evict_page_cache_on_write_ = false;
+  uint64_t last_cache_evict_offset_ = 0;
+
   // all the compaction outputs so far
   std::vector<Output> outputs_;
 
@@ -283,6 +326,102 @@ class CompactionOutputs {
   std::unique_ptr<SstPartitioner> partitioner_;
 };
 
+template <typename OpenFn, typename CloseFn>
+Status CompactionOutputs::AddToOutput(const CompactionIterator& c_iter,
+                                      const OpenFn& open_file_func,
+                                      const CloseFn& close_file_func) {
+  Status s;
+  const Slice& key = c_iter.key();
+
+  if (!pending_close_ && c_iter.Valid() && partitioner_ && HasBuilder() &&
+      partitioner_->ShouldPartition(
+          PartitionerRequest(last_key_for_partitioner_, c_iter.user_key(),
+                             current_output_file_size_)) == kRequired) {
+    pending_close_ = true;
+  }
+
+  if (pending_close_) {
+    s = close_file_func(*this, c_iter.InputStatus(), key);
+    pending_close_ = false;
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Open output file if necessary
+  if (!HasBuilder()) {
+    s = open_file_func(*this);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  Output& curr = current_output();
+  assert(builder_ != nullptr);
+  const Slice& value = c_iter.value();
+  s = curr.validator.Add(key, value);
+  if (!s.ok()) {
+    return s;
+  }
+  builder_->Add(key, value);
+
+  stats_.num_output_records++;
+  current_output_file_size_ = builder_->EstimatedFileSize();
+
+  // With buffered writes a large output keeps accumulating cached pages
+  // until close, evicting hotter foreground data in the meantime.
+  // Periodically drop fully written ranges while the file grows, always
+  // leaving the most recent chunk alone since its pages may still be dirty.
+  // Dirty pages are not reclaimed by the advise, but it kicks off their
+  // writeback so the next round (or the close-time drop in WriterSyncClose)
+  // can reclaim them.
+  if (evict_page_cache_on_write_) {
+    constexpr uint64_t kCacheEvictChunk = 8 * 1024 * 1024;
+    if (current_output_file_size_ >=
+        last_cache_evict_offset_ + 2 * kCacheEvictChunk) {
+      const uint64_t evict_up_to = current_output_file_size_ - kCacheEvictChunk;
+      file_writer_
+          ->InvalidateCache(static_cast<size_t>(last_cache_evict_offset_),
+                            static_cast<size_t>(evict_up_to -
+                                                last_cache_evict_offset_))
+          .PermitUncheckedError();
+      last_cache_evict_offset_ = evict_up_to;
+    }
+  }
+
+  if (blob_garbage_meter_) {
+    s = blob_garbage_meter_->ProcessOutFlow(key, value);
+  }
+
+  if (!s.ok()) {
+    return s;
+  }
+
+  const ParsedInternalKey& ikey = c_iter.ikey();
+  s = current_output().meta.UpdateBoundaries(key, value, ikey.sequence,
+                                             ikey.type);
+
+  // Close output file if it is big enough. Two possibilities determine it's
+  // time to close it: (1) the current key should be this file's last key, (2)
+  // the next key should not be in this file.
+  //
+  // TODO(aekmekji): determine if file should be closed earlier than this
+  // during subcompactions (i.e. if output size, estimated by input size, is
+  // going to be 1.2MB and max_output_file_size = 1MB, prefer to have 0.6MB
+  // and 0.6MB instead of 1MB and 0.2MB)
+  if (compaction_->output_level() != 0 &&
+      current_output_file_size_ >= compaction_->max_output_file_size()) {
+    pending_close_ = true;
+  }
+
+  if (partitioner_) {
+    last_key_for_partitioner_.assign(c_iter.user_key().data_,
+                                     c_iter.user_key().size_);
+  }
+
+  return s;
+}
+
 // helper struct to concatenate the last level and penultimate level outputs
 // which could be replaced by std::ranges::join_view() in c++20
 struct OutputIterator {
@@ -9,6 +9,7 @@
 
 #include "db/compaction/compaction_picker_level.h"
 
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
@@ -341,18 +342,24 @@ Compaction* LevelCompactionBuilder::PickCompaction() {
   }
 
 
-  if(compaction_inputs_.size() > 1 && !grandparents_.empty()){
+  // The grandparent overlap walk below exists only to feed the score log
+  // records, so skip it (and its per-file comparator calls) entirely when
+  // info logging is disabled, and emit one aggregated record instead of one
+  // line per input file.
+  if (compaction_inputs_.size() > 1 && !grandparents_.empty() &&
+      spdlog::should_log(spdlog::level::info)) {
     SPDLOG_INFO("score begin");
     //[first victim sst] [outputlevel score]
     SPDLOG_INFO("downlevelscore {} {}", start_level_inputs_.files[0]->fd.GetNumber(), vstorage_->CompactionLevelScore(output_level_));
     auto next_level_it = grandparents_.begin();
+    std::string sst_scores;
     for (auto& file : compaction_inputs_[compaction_inputs_.size()-1].files) {
       uint64_t overlapping_bytes = 0;
           // Skip files in next level that is smaller than current file
       while (next_level_it != grandparents_.end() &&
             compaction_picker_->icmp()->Compare((*next_level_it)->largest, file->smallest) < 0) {
         next_level_it++;
-        
+
       }
 
       while (next_level_it != grandparents_.end() &&
@@ -366,9 +373,12 @@ Compaction* LevelCompactionBuilder::PickCompaction() {
         next_level_it++;
       }
       assert(file->compensated_file_size != 0);
-      SPDLOG_INFO("downsstscore {} {}", file->fd.GetNumber(), overlapping_bytes * 1024U / file->compensated_file_size);
+      fmt::format_to(std::back_inserter(sst_scores), "{}:{} ",
+                     file->fd.GetNumber(),
+                     overlapping_bytes * 1024U / file->compensated_file_size);
     }
-     SPDLOG_INFO("score end");
+    SPDLOG_INFO("downsstscore {}", sst_scores);
+    SPDLOG_INFO("score end");
   }
   // Form a compaction object containing the files we picked.
   Compaction* c = GetCompaction();
@@ -213,10 +213,13 @@ std::string CompactionServiceCompactionJob::GetTableFileName(
   return MakeTableFileName(output_path_, file_number);
 }
 
-void CompactionServiceCompactionJob::RecordCompactionIOStats() {
-  compaction_result_->bytes_read += IOSTATS(bytes_read);
-  compaction_result_->bytes_written += IOSTATS(bytes_written);
-  CompactionJob::RecordCompactionIOStats();
+void CompactionServiceCompactionJob::GatherCompactionIOStats(
+    uint64_t& read_bytes, uint64_t& write_bytes) {
+  const uint64_t prev_read_bytes = read_bytes;
+  const uint64_t prev_write_bytes = write_bytes;
+  CompactionJob::GatherCompactionIOStats(read_bytes, write_bytes);
+  compaction_result_->bytes_read += read_bytes - prev_read_bytes;
+  compaction_result_->bytes_written += write_bytes - prev_write_bytes;
 }
 
 CompactionServiceCompactionJob::CompactionServiceCompactionJob(
@@ -260,6 +263,7 @@ Status CompactionServiceCompactionJob::Run() {
   write_hint_ =
       c->column_family_data()->CalculateSSTWriteHint(c->output_level());
   bottommost_level_ = c->bottommost_level();
+  ResolveOutputTemperature();
 
   Slice begin = compaction_input_.begin;
   Slice end = compaction_input_.end;
@@ -128,7 +128,7 @@ Slice SubcompactionState::LargestUserKey() const {
   }
 }
 
-bool SubcompactionState::ShouldStopBefore(const Slice& internal_key) {
+bool SubcompactionState::ShouldStopBeforeImpl(const Slice& internal_key) {
   uint64_t curr_file_size = Current().GetCurrentOutputFileSize();
   const InternalKeyComparator* icmp =
       &compaction->column_family_data()->internal_comparator();
@@ -205,19 +205,4 @@ bool SubcompactionState::ShouldStopBefore(const Slice& internal_key) {
   return false;
 }
 
-Status SubcompactionState::AddToOutput(
-    const CompactionIterator& iter,
-    const CompactionFileOpenFunc& open_file_func,
-    const CompactionFileCloseFunc& close_file_func) {
-  // update target output first
-  is_current_penultimate_level_ = iter.output_to_penultimate_level();
-  current_outputs_ = is_current_penultimate_level_ ? &penultimate_level_outputs_
-                                                   : &compaction_outputs_;
-  if (is_current_penultimate_level_) {
-    has_penultimate_level_outputs_ = true;
-  }
-
-  return Current().AddToOutput(iter, open_file_func, close_file_func);
-}
-
 }  // namespace ROCKSDB_NAMESPACE
@@ -21,6 +21,7 @@
 
 #include <spdlog/spdlog.h>
 #include <chrono>
+#include <iterator>
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -54,7 +55,10 @@ class SubcompactionState {
 
   // The boundaries of the key-range this compaction is interested in. No two
   // sub-compactions may have overlapping key-ranges.
-  // 'start' is inclusive, 'end' is exclusive, and nullptr means unbounded
+  // 'start' is inclusive, 'end' is exclusive, and nullptr means unbounded.
+  // The pointed-to key bytes are owned by this SubcompactionState (copied in
+  // the constructor), so the boundary stays on the same cachelines as the
+  // rest of the per-key state instead of in a separate array on the job.
   const Slice *start, *end;
 
   // The return status of this sub-compaction
@@ -70,6 +74,20 @@ class SubcompactionState {
   // compaction job stats for this sub-compaction
   CompactionJobStats compaction_job_stats;
 
+  // Wall-clock seconds sampled when the first output file of this
+  // subcompaction is opened; reused as the creation time of every subsequent
+  // output so each file open does not re-query the clock. 0 means not
+  // sampled yet.
+  uint64_t cached_wall_time = 0;
+
+  // Minimum oldest-ancester-time over the input files overlapping this
+  // subcompaction's key range. The inputs and range are fixed while the
+  // subcompaction runs, so the O(inputs) scan is done once on the first
+  // output file open instead of per file; kMax means no input had a known
+  // time and each output falls back to its creation time.
+  uint64_t min_oldest_ancester_time = 0;
+  bool min_oldest_ancester_time_resolved = false;
+
   // sub-compaction job id, which is used to identify different sub-compaction
   // within the same compaction job.
   const uint32_t sub_job_id;
@@ -120,15 +138,25 @@ class SubcompactionState {
   SubcompactionState(const SubcompactionState&) = delete;
   SubcompactionState& operator=(const SubcompactionState&) = delete;
 
-  SubcompactionState(Compaction* c, Slice* _start, Slice* _end,
+  SubcompactionState(Compaction* c, const Slice* _start, const Slice* _end,
                      uint32_t _sub_job_id)
       : compaction(c),
-        start(_start),
-        end(_end),
+        start(nullptr),
+        end(nullptr),
         sub_job_id(_sub_job_id),
         compaction_outputs_(c, /*is_penultimate_level=*/false),
         penultimate_level_outputs_(c, /*is_penultimate_level=*/true) {
     assert(compaction != nullptr);
+    if (_start != nullptr) {
+      start_key_storage_.assign(_start->data(), _start->size());
+      start_slice_ = Slice(start_key_storage_);
+      start = &start_slice_;
+    }
+    if (_end != nullptr) {
+      end_key_storage_.assign(_end->data(), _end->size());
+      end_slice_ = Slice(end_key_storage_);
+      end = &end_slice_;
+    }
     const InternalKeyComparator* icmp =
         &compaction->column_family_data()->internal_comparator();
     const InternalKey* output_split_key = compaction->GetOutputSplitKey();
@@ -148,14 +176,20 @@ class SubcompactionState {
 
   SubcompactionState(SubcompactionState&& state) noexcept
       : compaction(state.compaction),
-        start(state.start),
-        end(state.end),
+        start(nullptr),
+        end(nullptr),
         status(std::move(state.status)),
         io_status(std::move(state.io_status)),
         notify_on_subcompaction_completion(
             state.notify_on_subcompaction_completion),
         compaction_job_stats(std::move(state.compaction_job_stats)),
+        cached_wall_time(state.cached_wall_time),
+        min_oldest_ancester_time(state.min_oldest_ancester_time),
+        min_oldest_ancester_time_resolved(
+            state.min_oldest_ancester_time_resolved),
         sub_job_id(state.sub_job_id),
+        start_key_storage_(std::move(state.start_key_storage_)),
+        end_key_storage_(std::move(state.end_key_storage_)),
         files_to_cut_for_ttl_(std::move(state.files_to_cut_for_ttl_)),
         cur_files_to_cut_for_ttl_(state.cur_files_to_cut_for_ttl_),
         next_files_to_cut_for_ttl_(state.next_files_to_cut_for_ttl_),
@@ -169,6 +203,17 @@ class SubcompactionState {
     current_outputs_ = is_current_penultimate_level_
                            ? &penultimate_level_outputs_
                            : &compaction_outputs_;
+    // Re-point the boundary slices at the moved storage: short strings live
+    // in the SSO buffer, which relocates on move. `state.start`/`state.end`
+    // are only consulted as null/non-null flags here.
+    if (state.start != nullptr) {
+      start_slice_ = Slice(start_key_storage_);
+      start = &start_slice_;
+    }
+    if (state.end != nullptr) {
+      end_slice_ = Slice(end_key_storage_);
+      end = &end_slice_;
+    }
   }
 
   bool HasPenultimateLevelOutputs() const {
@@ -180,7 +225,25 @@ class SubcompactionState {
 
   // Returns true iff we should stop building the current output
   // before processing "internal_key".
-  bool ShouldStopBefore(const Slice& internal_key);
+  // Called once per key; the inline fast path covers the steady state where
+  // the key is still inside the current grandparent file (or past all of
+  // them) and neither the TTL-cut list nor the split cursor is armed — no
+  // cutpoint is possible then and the bookkeeping in ShouldStopBeforeImpl()
+  // can be skipped.
+  bool ShouldStopBefore(const Slice& internal_key) {
+    if ((local_output_split_key_ == nullptr || is_split_) &&
+        files_to_cut_for_ttl_.empty() && seen_key_) {
+      const std::vector<FileMetaData*>& grandparents =
+          compaction->grandparents();
+      if (grandparent_index_ >= grandparents.size() ||
+          compaction->column_family_data()->internal_comparator().Compare(
+              internal_key,
+              grandparents[grandparent_index_]->largest.Encode()) <= 0) {
+        return false;
+      }
+    }
+    return ShouldStopBeforeImpl(internal_key);
+  }
 
   bool IsCurrentPenultimateLevel() const {
     return is_current_penultimate_level_;
@@ -191,13 +254,26 @@ class SubcompactionState {
     for (const auto& file : penultimate_level_outputs_.outputs_) {
       out_edit->AddFile(compaction->GetPenultimateLevel(), file.meta);
     }
+    // Take the clock reading once and emit a single aggregated record
+    // instead of one line (and one spdlog mutex acquisition) per output
+    // file; skip the formatting entirely when info logging is off.
+    const bool log_adds = spdlog::should_log(spdlog::level::info);
+    std::string added_files;
     for (const auto& file : compaction_outputs_.outputs_) {
       out_edit->AddFile(compaction->output_level(), file.meta);
-      SPDLOG_INFO("add {} {} {}", file.meta.fd.GetNumber(), std::chrono::duration_cast<std::chrono::seconds>(
-                  std::chrono::system_clock::now().time_since_epoch())
-                  .count(), compaction->output_level());
+      if (log_adds) {
+        fmt::format_to(std::back_inserter(added_files), "{} ",
+                       file.meta.fd.GetNumber());
+      }
+    }
+    if (log_adds) {
+      SPDLOG_INFO("add {} {} {}", added_files,
+                  std::chrono::duration_cast<std::chrono::seconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count(),
+                  compaction->output_level());
+      SPDLOG_INFO("compaction end");
     }
-    SPDLOG_INFO("compaction end");
   }
 
   void Cleanup(Cache* cache);
@@ -211,24 +287,47 @@ class SubcompactionState {
   }
 
   // Add compaction_iterator key/value to the `Current` output group.
+  // Templated like CompactionOutputs::AddToOutput so the per-key path is
+  // inlinable into the compaction loop with concrete callables.
+  template <typename OpenFn, typename CloseFn>
   Status AddToOutput(const CompactionIterator& iter,
-                     const CompactionFileOpenFunc& open_file_func,
-                     const CompactionFileCloseFunc& close_file_func);
+                     const OpenFn& open_file_func,
+                     const CloseFn& close_file_func) {
+    // update target output first
+    is_current_penultimate_level_ = iter.output_to_penultimate_level();
+    current_outputs_ = is_current_penultimate_level_
+                           ? &penultimate_level_outputs_
+                           : &compaction_outputs_;
+    if (is_current_penultimate_level_) {
+      has_penultimate_level_outputs_ = true;
+    }
+
+    return Current().AddToOutput(iter, open_file_func, close_file_func);
+  }
 
   // Close all compaction output files, both output_to_penultimate_level outputs
   // and normal outputs.
   Status CloseCompactionFiles(const Status& curr_status,
+                              SequenceNumber earliest_snapshot,
                               const CompactionFileOpenFunc& open_file_func,
                               const CompactionFileCloseFunc& close_file_func) {
     // Call FinishCompactionOutputFile() even if status is not ok: it needs to
     // close the output file.
     Status s = penultimate_level_outputs_.CloseOutput(
-        curr_status, open_file_func, close_file_func);
-    s = compaction_outputs_.CloseOutput(s, open_file_func, close_file_func);
+        curr_status, start, end, earliest_snapshot, open_file_func,
+        close_file_func);
+    s = compaction_outputs_.CloseOutput(s, start, end, earliest_snapshot,
+                                        open_file_func, close_file_func);
     return s;
   }
 
  private:
+  // Owning storage for the boundary keys that `start`/`end` point into.
+  std::string start_key_storage_;
+  std::string end_key_storage_;
+  Slice start_slice_;
+  Slice end_slice_;
+
   // Some identified files with old oldest ancester time and the range should be
   // isolated out so that the output file(s) in that range can be merged down
   // for TTL and clear the timestamps for the range.
@@ -236,6 +335,9 @@ class SubcompactionState {
   int cur_files_to_cut_for_ttl_ = -1;
   int next_files_to_cut_for_ttl_ = 0;
 
+  // Full cutpoint logic; see ShouldStopBefore().
+  bool ShouldStopBeforeImpl(const Slice& internal_key);
+
   // An index that used to speed up ShouldStopBefore().
   size_t grandparent_index_ = 0;
   // The number of bytes overlapping between the current output and
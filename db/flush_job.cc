@@ -999,9 +999,12 @@ Status FlushJob::WriteLevel0Table() {
                    meta_.file_creation_time, meta_.file_checksum,
                    meta_.file_checksum_func_name, meta_.min_timestamp,
                    meta_.max_timestamp, meta_.unique_id);
-    SPDLOG_INFO("flush {} {}", meta_.fd.GetNumber(), std::chrono::duration_cast<std::chrono::seconds>(
-                  std::chrono::system_clock::now().time_since_epoch())
-                  .count());    
+    if (spdlog::should_log(spdlog::level::info)) {
+      SPDLOG_INFO("flush {} {}", meta_.fd.GetNumber(),
+                  std::chrono::duration_cast<std::chrono::seconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count());
+    }
     edit_->SetBlobFileAdditions(std::move(blob_file_additions));
   }
 #ifndef ROCKSDB_LITE
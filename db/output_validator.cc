@@ -6,14 +6,17 @@
 #include "db/output_validator.h"
 
 #include "test_util/sync_point.h"
-#include "util/hash.h"
 
 namespace ROCKSDB_NAMESPACE {
 Status OutputValidator::Add(const Slice& key, const Slice& value) {
   if (enable_hash_) {
-    // Generate a rolling 64-bit hash of the key and values
-    paranoid_hash_ = NPHash64(key.data(), key.size(), paranoid_hash_);
-    paranoid_hash_ = NPHash64(value.data(), value.size(), paranoid_hash_);
+    // Generate a streaming 64-bit hash of the keys and values
+    if (xxh_state_ == nullptr) {
+      xxh_state_ = XXH3_createState();
+      XXH3_64bits_reset(xxh_state_);
+    }
+    XXH3_64bits_update(xxh_state_, key.data(), key.size());
+    XXH3_64bits_update(xxh_state_, value.data(), value.size());
   }
   if (enable_order_check_) {
     TEST_SYNC_POINT_CALLBACK("OutputValidator::Add:order_check",
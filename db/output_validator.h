@@ -7,6 +7,7 @@
 #include "db/dbformat.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
+#include "util/xxhash.h"
 
 namespace ROCKSDB_NAMESPACE {
 // A class that validates key/value that is inserted to an SST file.
@@ -23,6 +24,34 @@ class OutputValidator {
         enable_order_check_(enable_order_check),
         enable_hash_(enable_hash) {}
 
+  OutputValidator(const OutputValidator& src)
+      : icmp_(src.icmp_),
+        prev_key_(src.prev_key_),
+        paranoid_hash_(src.paranoid_hash_),
+        enable_order_check_(src.enable_order_check_),
+        enable_hash_(src.enable_hash_) {
+    if (src.xxh_state_ != nullptr) {
+      xxh_state_ = XXH3_createState();
+      XXH3_copyState(xxh_state_, src.xxh_state_);
+    }
+  }
+
+  OutputValidator(OutputValidator&& src) noexcept
+      : icmp_(src.icmp_),
+        prev_key_(std::move(src.prev_key_)),
+        paranoid_hash_(src.paranoid_hash_),
+        enable_order_check_(src.enable_order_check_),
+        enable_hash_(src.enable_hash_),
+        xxh_state_(src.xxh_state_) {
+    src.xxh_state_ = nullptr;
+  }
+
+  ~OutputValidator() {
+    if (xxh_state_ != nullptr) {
+      XXH3_freeState(xxh_state_);
+    }
+  }
+
   // Add a key to the KV sequence, and return whether the key follows
   // criteria, e.g. key is ordered.
   Status Add(const Slice& key, const Slice& value);
@@ -36,13 +65,22 @@ class OutputValidator {
 
   // Not (yet) intended to be persisted, so subject to change
   // without notice between releases.
-  uint64_t GetHash() const { return paranoid_hash_; }
+  uint64_t GetHash() const {
+    return xxh_state_ != nullptr ? XXH3_64bits_digest(xxh_state_)
+                                 : paranoid_hash_;
+  }
 
  private:
   const InternalKeyComparator& icmp_;
   std::string prev_key_;
+  // Holds a precalculated hash when this validator was built from one (e.g.
+  // received from a remote compaction) instead of from Add() calls.
   uint64_t paranoid_hash_ = 0;
   bool enable_order_check_;
   bool enable_hash_;
+  // Streaming XXH3 state over all added keys and values, allocated lazily on
+  // the first Add(). Streaming updates avoid re-running hash setup and
+  // finalization for every record the way a seed-chained one-shot hash does.
+  XXH3_state_t* xxh_state_ = nullptr;
 };
 }  // namespace ROCKSDB_NAMESPACE
@@ -564,6 +564,17 @@ void TableCache::Evict(Cache* cache, uint64_t file_number) {
   cache->Erase(GetSliceForFileNumber(&file_number));
 }
 
+void TableCache::EvictPageCache(uint64_t file_number) {
+  Cache::Handle* handle = cache_->Lookup(GetSliceForFileNumber(&file_number));
+  if (handle != nullptr) {
+    TableReader* table_reader = GetTableReaderFromHandle(handle);
+    if (table_reader != nullptr) {
+      table_reader->EvictPageCache();
+    }
+    ReleaseHandle(handle);
+  }
+}
+
 uint64_t TableCache::ApproximateOffsetOf(
     const Slice& key, const FileDescriptor& fd, TableReaderCaller caller,
     const InternalKeyComparator& internal_comparator,
@@ -127,6 +127,11 @@ class TableCache {
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
+  // If a reader for the specified file number is open in the cache, advise
+  // the OS to drop the file's pages from the buffer cache. Best-effort: a
+  // file without an open reader is skipped.
+  void EvictPageCache(uint64_t file_number);
+
   // Query whether specified file number is currently in cache
   static bool HasEntry(Cache* cache, uint64_t file_number);
 
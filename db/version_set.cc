@@ -5911,9 +5911,8 @@ void VersionSet::AddLiveFiles(std::vector<uint64_t>* live_table_files,
 InternalIterator* VersionSet::MakeInputIterator(
     const ReadOptions& read_options, const Compaction* c,
     RangeDelAggregator* range_del_agg,
-    const FileOptions& file_options_compactions,
-    const std::optional<const Slice>& start,
-    const std::optional<const Slice>& end) {
+    const FileOptions& file_options_compactions, const Slice* start,
+    const Slice* end) {
   auto cfd = c->column_family_data();
   // Level-0 files have to be merged together.  For other levels,
   // we will make a concatenating iterator per level.
@@ -5929,16 +5928,16 @@ InternalIterator* VersionSet::MakeInputIterator(
         const LevelFilesBrief* flevel = c->input_levels(which);
         for (size_t i = 0; i < flevel->num_files; i++) {
           const FileMetaData& fmd = *flevel->files[i].file_metadata;
-          if (start.has_value() &&
-              cfd->user_comparator()->Compare(start.value(),
+          if (start != nullptr &&
+              cfd->user_comparator()->Compare(*start,
                                               fmd.largest.user_key()) > 0) {
             continue;
           }
           // We should be able to filter out the case where the end key
           // equals to the end boundary, since the end key is exclusive.
           // We try to be extra safe here.
-          if (end.has_value() &&
-              cfd->user_comparator()->Compare(end.value(),
+          if (end != nullptr &&
+              cfd->user_comparator()->Compare(*end,
                                               fmd.smallest.user_key()) < 0) {
             continue;
           }
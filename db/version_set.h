@@ -1335,13 +1335,12 @@ class VersionSet {
   // Create an iterator that reads over the compaction inputs for "*c".
   // The caller should delete the iterator when no longer needed.
   // @param read_options Must outlive the returned iterator.
-  // @param start, end indicates compaction range
+  // @param start, end indicates compaction range, nullptr means unbounded
   InternalIterator* MakeInputIterator(
       const ReadOptions& read_options, const Compaction* c,
       RangeDelAggregator* range_del_agg,
-      const FileOptions& file_options_compactions,
-      const std::optional<const Slice>& start,
-      const std::optional<const Slice>& end);
+      const FileOptions& file_options_compactions, const Slice* start,
+      const Slice* end);
 
   // Add all files listed in any live version to *live_table_files and
   // *live_blob_files. Note that these lists may contain duplicates.
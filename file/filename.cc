@@ -70,7 +70,16 @@ static std::string MakeFileName(uint64_t number, const char* suffix) {
 
 static std::string MakeFileName(const std::string& name, uint64_t number,
                                 const char* suffix) {
-  return name + "/" + MakeFileName(number, suffix);
+  // Build the result in one allocation instead of the three that chained
+  // operator+ would make; table file names are constructed once per SST
+  // open/create.
+  char buf[100];
+  int len = snprintf(buf, sizeof(buf), "/%06llu.%s",
+                     static_cast<unsigned long long>(number), suffix);
+  std::string result;
+  result.reserve(name.size() + len);
+  result.append(name).append(buf, len);
+  return result;
 }
 
 std::string LogFileName(const std::string& name, uint64_t number) {
@@ -139,12 +148,9 @@ uint64_t TableFileNameToNumber(const std::string& name) {
 std::string TableFileName(const std::vector<DbPath>& db_paths, uint64_t number,
                           uint32_t path_id) {
   assert(number > 0);
-  std::string path;
-  if (path_id >= db_paths.size()) {
-    path = db_paths.back().path;
-  } else {
-    path = db_paths[path_id].path;
-  }
+  const std::string& path = (path_id >= db_paths.size())
+                                ? db_paths.back().path
+                                : db_paths[path_id].path;
   return MakeTableFileName(path, number);
 }
 
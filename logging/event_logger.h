@@ -5,9 +5,11 @@
 
 #pragma once
 
+#include <cstdio>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <chrono>
 
 #include "logging/log_buffer.h"
@@ -18,15 +20,22 @@ namespace ROCKSDB_NAMESPACE {
 class JSONWriter {
  public:
   JSONWriter() : state_(kExpectKey), first_element_(true), in_array_(false) {
-    stream_ << "{";
+    json_.reserve(256);
+    json_ += '{';
   }
 
-  void AddKey(const std::string& key) {
+  void AddKey(const std::string& key) { AddKey(key.c_str()); }
+
+  // Overload avoiding a temporary std::string for the string-literal keys
+  // that make up nearly all event log fields.
+  void AddKey(const char* key) {
     assert(state_ == kExpectKey);
     if (!first_element_) {
-      stream_ << ", ";
+      json_ += ", ";
     }
-    stream_ << "\"" << key << "\": ";
+    json_ += '"';
+    json_ += key;
+    json_ += "\": ";
     state_ = kExpectValue;
     first_element_ = false;
   }
@@ -34,9 +43,11 @@ class JSONWriter {
   void AddValue(const char* value) {
     assert(state_ == kExpectValue || state_ == kInArray);
     if (state_ == kInArray && !first_element_) {
-      stream_ << ", ";
+      json_ += ", ";
     }
-    stream_ << "\"" << value << "\"";
+    json_ += '"';
+    json_ += value;
+    json_ += '"';
     if (state_ != kInArray) {
       state_ = kExpectKey;
     }
@@ -47,9 +58,37 @@ class JSONWriter {
   void AddValue(const T& value) {
     assert(state_ == kExpectValue || state_ == kInArray);
     if (state_ == kInArray && !first_element_) {
-      stream_ << ", ";
+      json_ += ", ";
+    }
+    if constexpr (std::is_integral<T>::value && !std::is_same<T, bool>::value) {
+      // Format integers into a stack buffer instead of going through the
+      // ostream's locale-aware num_put, which is the dominant cost of
+      // building an event record (compaction events alone carry dozens of
+      // integer fields).
+      char buf[24];
+      int len;
+      if constexpr (std::is_signed<T>::value) {
+        len = snprintf(buf, sizeof(buf), "%lld",
+                       static_cast<long long>(value));
+      } else {
+        len = snprintf(buf, sizeof(buf), "%llu",
+                       static_cast<unsigned long long>(value));
+      }
+      assert(len > 0 && static_cast<size_t>(len) < sizeof(buf));
+      json_.append(buf, len);
+    } else if constexpr (std::is_floating_point<T>::value) {
+      // %g matches the six-significant-digit default of the ostream
+      // formatting used before.
+      char buf[32];
+      int len = snprintf(buf, sizeof(buf), "%g", static_cast<double>(value));
+      assert(len > 0 && static_cast<size_t>(len) < sizeof(buf));
+      json_.append(buf, len);
+    } else {
+      // Fallback for the rare value types without a direct append path.
+      std::ostringstream oss;
+      oss << value;
+      json_ += oss.str();
     }
-    stream_ << value;
     if (state_ != kInArray) {
       state_ = kExpectKey;
     }
@@ -60,7 +99,7 @@ class JSONWriter {
     assert(state_ == kExpectValue);
     state_ = kInArray;
     in_array_ = true;
-    stream_ << "[";
+    json_ += '[';
     first_element_ = true;
   }
 
@@ -68,20 +107,20 @@ class JSONWriter {
     assert(state_ == kInArray);
     state_ = kExpectKey;
     in_array_ = false;
-    stream_ << "]";
+    json_ += ']';
     first_element_ = false;
   }
 
   void StartObject() {
     assert(state_ == kExpectValue);
     state_ = kExpectKey;
-    stream_ << "{";
+    json_ += '{';
     first_element_ = true;
   }
 
   void EndObject() {
     assert(state_ == kExpectKey);
-    stream_ << "}";
+    json_ += '}';
     first_element_ = false;
   }
 
@@ -89,7 +128,7 @@ class JSONWriter {
     assert(state_ == kInArray && in_array_);
     state_ = kExpectValue;
     if (!first_element_) {
-      stream_ << ", ";
+      json_ += ", ";
     }
     StartObject();
   }
@@ -100,7 +139,7 @@ class JSONWriter {
     state_ = kInArray;
   }
 
-  std::string Get() const { return stream_.str(); }
+  const std::string& Get() const { return json_; }
 
   JSONWriter& operator<<(const char* val) {
     if (state_ == kExpectKey) {
@@ -132,7 +171,10 @@ class JSONWriter {
   JSONWriterState state_;
   bool first_element_;
   bool in_array_;
-  std::ostringstream stream_;
+  // Backing buffer; records are built with direct appends, so an event
+  // costs a few amortized string growths instead of ostringstream's
+  // locale-aware formatting machinery per field.
+  std::string json_;
 };
 
 class EventLoggerStream {
@@ -94,6 +94,18 @@ void ThreadStatusUpdater::SetThreadOperationProperty(int i, uint64_t value) {
   data->op_properties[i].store(value, std::memory_order_relaxed);
 }
 
+void ThreadStatusUpdater::SetThreadOperationProperties(int i,
+                                                       const uint64_t* values,
+                                                       int count) {
+  auto* data = GetLocalThreadStatus();
+  if (data == nullptr) {
+    return;
+  }
+  for (int j = 0; j < count; j++) {
+    data->op_properties[i + j].store(values[j], std::memory_order_relaxed);
+  }
+}
+
 void ThreadStatusUpdater::IncreaseThreadOperationProperty(int i,
                                                           uint64_t delta) {
   auto* data = GetLocalThreadStatus();
@@ -311,6 +323,9 @@ void ThreadStatusUpdater::EraseDatabaseInfo(const void* /*db_key*/) {}
 void ThreadStatusUpdater::SetThreadOperationProperty(int /*i*/,
                                                      uint64_t /*value*/) {}
 
+void ThreadStatusUpdater::SetThreadOperationProperties(
+    int /*i*/, const uint64_t* /*values*/, int /*count*/) {}
+
 void ThreadStatusUpdater::IncreaseThreadOperationProperty(int /*i*/,
                                                           uint64_t /*delta*/) {}
 
@@ -145,6 +145,11 @@ class ThreadStatusUpdater {
   void SetThreadOperationProperty(
       int i, uint64_t value);
 
+  // Set `count` consecutive properties of the current operation starting at
+  // the "i"th one, resolving the thread-local status only once.
+  void SetThreadOperationProperties(
+      int i, const uint64_t* values, int count);
+
   // Increase the "i"th property of the current operation with
   // the specified delta.
   void IncreaseThreadOperationProperty(
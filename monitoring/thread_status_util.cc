@@ -89,6 +89,19 @@ void ThreadStatusUtil::SetThreadOperationProperty(int code, uint64_t value) {
   thread_updater_local_cache_->SetThreadOperationProperty(code, value);
 }
 
+void ThreadStatusUtil::SetThreadOperationProperties(int code,
+                                                    const uint64_t* values,
+                                                    int count) {
+  if (thread_updater_local_cache_ == nullptr) {
+    // thread_updater_local_cache_ must be set in SetColumnFamily
+    // or other ThreadStatusUtil functions.
+    return;
+  }
+
+  thread_updater_local_cache_->SetThreadOperationProperties(code, values,
+                                                            count);
+}
+
 void ThreadStatusUtil::IncreaseThreadOperationProperty(int code,
                                                        uint64_t delta) {
   if (thread_updater_local_cache_ == nullptr) {
@@ -181,6 +194,10 @@ void ThreadStatusUtil::SetThreadOperation(ThreadStatus::OperationType /*op*/) {}
 void ThreadStatusUtil::SetThreadOperationProperty(int /*code*/,
                                                   uint64_t /*value*/) {}
 
+void ThreadStatusUtil::SetThreadOperationProperties(int /*code*/,
+                                                    const uint64_t* /*values*/,
+                                                    int /*count*/) {}
+
 void ThreadStatusUtil::IncreaseThreadOperationProperty(int /*code*/,
                                                        uint64_t /*delta*/) {}
 
@@ -65,6 +65,11 @@ class ThreadStatusUtil {
   static void SetThreadOperationProperty(
       int code, uint64_t value);
 
+  // Set `count` consecutive properties starting at `code` in one shot,
+  // resolving the thread-local status slot only once.
+  static void SetThreadOperationProperties(
+      int code, const uint64_t* values, int count);
+
   static void IncreaseThreadOperationProperty(
       int code, uint64_t delta);
 
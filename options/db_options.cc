@@ -984,7 +984,7 @@ MutableDBOptions::MutableDBOptions()
       bytes_per_sync(0),
       wal_bytes_per_sync(0),
       strict_bytes_per_sync(false),
-      compaction_readahead_size(0),
+      compaction_readahead_size(2 * 1024 * 1024),
       max_background_flushes(-1) {}
 
 MutableDBOptions::MutableDBOptions(const DBOptions& options)
@@ -1157,6 +1157,14 @@ void BlockBasedTable::SetupForCompaction() {
   }
 }
 
+void BlockBasedTable::EvictPageCache() {
+  if (rep_ != nullptr && rep_->file != nullptr) {
+    // Dropping the advise on the floor is fine: this is an eviction hint and
+    // some file systems do not implement InvalidateCache.
+    rep_->file->file()->InvalidateCache(0, 0).PermitUncheckedError();
+  }
+}
+
 std::shared_ptr<const TableProperties> BlockBasedTable::GetTableProperties()
     const {
   return rep_->table_properties;
@@ -90,6 +90,12 @@ class TableReader {
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
 
+  // Best-effort hint that this table's pages in the OS buffer cache are no
+  // longer needed, e.g. because the file was just compacted away and will be
+  // deleted once its last reference is released. Readers that do not hold an
+  // open file descriptor may ignore it.
+  virtual void EvictPageCache() {}
+
   virtual std::shared_ptr<const TableProperties> GetTableProperties() const = 0;
 
   // Prepare work that can be done before the real Get()
@@ -56,15 +56,12 @@ Status DecodeSessionId(const std::string &db_session_id, uint64_t *upper,
   return Status::OK();
 }
 
-Status GetSstInternalUniqueId(const std::string &db_id,
-                              const std::string &db_session_id,
-                              uint64_t file_number, UniqueIdPtr out) {
+Status GetSstInternalUniqueIdPrefix(const std::string &db_id,
+                                    const std::string &db_session_id,
+                                    UniqueId64x3 *out) {
   if (db_id.empty()) {
     return Status::NotSupported("Missing db_id");
   }
-  if (file_number == 0) {
-    return Status::NotSupported("Missing or bad file number");
-  }
   if (db_session_id.empty()) {
     return Status::NotSupported("Missing db_session_id");
   }
@@ -84,7 +81,7 @@ Status GetSstInternalUniqueId(const std::string &db_id,
   // that here because of testing and old versions.)
   // We put this first in anticipation of matching a small-ish set of cache
   // key prefixes to cover entries relevant to any DB.
-  out.ptr[0] = session_lower;
+  (*out)[0] = session_lower;
 
   // Hash the session upper (~39 bits entropy) and DB id (120+ bits entropy)
   // for very high global uniqueness entropy.
@@ -93,20 +90,46 @@ Status GetSstInternalUniqueId(const std::string &db_id,
   // more common for different DBs to have different DB ids.)
   uint64_t db_a, db_b;
   Hash2x64(db_id.data(), db_id.size(), session_upper, &db_a, &db_b);
+  (*out)[1] = db_a;
+  (*out)[2] = db_b;
+
+  return Status::OK();
+}
+
+Status GetSstInternalUniqueIdFromPrefix(const UniqueId64x3 &prefix,
+                                        uint64_t file_number, UniqueIdPtr out) {
+  if (file_number == 0) {
+    return Status::NotSupported("Missing or bad file number");
+  }
+  out.ptr[0] = prefix[0];
 
   // Xor in file number for guaranteed uniqueness by file number for a given
   // session and DB id. (Xor slightly better than + here. See
   // https://github.com/pdillinger/unique_id )
-  out.ptr[1] = db_a ^ file_number;
+  out.ptr[1] = prefix[1] ^ file_number;
 
   // Extra (optional) global uniqueness
   if (out.extended) {
-    out.ptr[2] = db_b;
+    out.ptr[2] = prefix[2];
   }
 
   return Status::OK();
 }
 
+Status GetSstInternalUniqueId(const std::string &db_id,
+                              const std::string &db_session_id,
+                              uint64_t file_number, UniqueIdPtr out) {
+  if (file_number == 0) {
+    return Status::NotSupported("Missing or bad file number");
+  }
+  UniqueId64x3 prefix;
+  Status s = GetSstInternalUniqueIdPrefix(db_id, db_session_id, &prefix);
+  if (!s.ok()) {
+    return s;
+  }
+  return GetSstInternalUniqueIdFromPrefix(prefix, file_number, out);
+}
+
 Status GetSstInternalUniqueId(const std::string &db_id,
                               const std::string &db_session_id,
                               uint64_t file_number, UniqueId64x2 *out) {
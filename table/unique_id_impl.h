@@ -49,6 +49,19 @@ Status GetSstInternalUniqueId(const std::string &db_id,
                               const std::string &db_session_id,
                               uint64_t file_number, UniqueIdPtr out);
 
+// Computes the db_id/db_session_id-dependent portion of the internal unique
+// id (the session-id decode plus db-id hash). Callers creating many files
+// under one session, such as a compaction job, can compute this once and
+// derive each file's id with GetSstInternalUniqueIdFromPrefix().
+Status GetSstInternalUniqueIdPrefix(const std::string &db_id,
+                                    const std::string &db_session_id,
+                                    UniqueId64x3 *out);
+
+// Folds a file number into a prefix from GetSstInternalUniqueIdPrefix(),
+// producing exactly the id GetSstInternalUniqueId() would.
+Status GetSstInternalUniqueIdFromPrefix(const UniqueId64x3 &prefix,
+                                        uint64_t file_number, UniqueIdPtr out);
+
 // Helper for GetUniqueIdFromTableProperties. External unique ids go through
 // this extra hashing layer so that prefixes of the unique id have predictable
 // "full" entropy. This hashing layer is 1-to-1 on the first 128 bits and on